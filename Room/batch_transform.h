@@ -0,0 +1,298 @@
+#ifndef BATCH_TRANSFORM_H
+#define BATCH_TRANSFORM_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// AVX when the compiler targets it (/arch:AVX, -mavx), else SSE on any x86-64 or
+// SSE2 build, else plain floats
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BATCH_TRANSFORM_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define BATCH_TRANSFORM_SSE 1
+#endif
+
+namespace batch_detail
+{
+#if defined(BATCH_TRANSFORM_AVX)
+    typedef __m256 Lane;
+    const int LANES = 8;
+    inline Lane load(const float* p) { return _mm256_loadu_ps(p); }
+    inline void store(float* p, Lane a) { _mm256_storeu_ps(p, a); }
+    inline Lane splat(float x) { return _mm256_set1_ps(x); }
+    inline Lane add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+    inline Lane sub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+    inline Lane mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+#elif defined(BATCH_TRANSFORM_SSE)
+    typedef __m128 Lane;
+    const int LANES = 4;
+    inline Lane load(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, Lane a) { _mm_storeu_ps(p, a); }
+    inline Lane splat(float x) { return _mm_set1_ps(x); }
+    inline Lane add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+    inline Lane sub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+    inline Lane mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+#else
+    typedef float Lane;
+    const int LANES = 1;
+    inline Lane load(const float* p) { return *p; }
+    inline void store(float* p, Lane a) { *p = a; }
+    inline Lane splat(float x) { return x; }
+    inline Lane add(Lane a, Lane b) { return a + b; }
+    inline Lane sub(Lane a, Lane b) { return a - b; }
+    inline Lane mul(Lane a, Lane b) { return a * b; }
+#endif
+
+    // arrays are padded to whole lanes so the loops need no scalar tail
+    inline size_t padded(size_t count)
+    {
+        return (count + LANES - 1) / LANES * LANES;
+    }
+}
+
+// std::vector storage on 32-byte boundaries, so a lane never straddles a cache line
+template <typename T>
+struct AlignedAllocator
+{
+    typedef T value_type;
+    static const size_t ALIGNMENT = 32;
+
+    AlignedAllocator() {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+#ifdef _WIN32
+        void* p = _aligned_malloc(n * sizeof(T), ALIGNMENT);
+#else
+        void* p = nullptr;
+        if (posix_memalign(&p, ALIGNMENT, n * sizeof(T)) != 0)
+            p = nullptr;
+#endif
+        if (!p)
+            throw std::bad_alloc();
+        return (T*)p;
+    }
+
+    void deallocate(T* p, size_t)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+typedef std::vector<float, AlignedAllocator<float> > FloatArray;
+
+// translate, rotation as a unit quaternion and scale of many objects, one array
+// per component
+struct QuaternionSoA
+{
+    FloatArray tx, ty, tz, qx, qy, qz, qw, sx, sy, sz;
+    size_t count = 0;
+
+    void resize(size_t n)
+    {
+        count = n;
+        size_t lanes = batch_detail::padded(n);
+        FloatArray* arrays[10] = { &tx, &ty, &tz, &qx, &qy, &qz, &qw, &sx, &sy, &sz };
+        for (FloatArray* a : arrays)
+            a->resize(lanes, 0.0f);
+    }
+
+    void set(size_t i, const glm::vec3& t, const glm::quat& q, const glm::vec3& s)
+    {
+        tx[i] = t.x; ty[i] = t.y; tz[i] = t.z;
+        qx[i] = q.x; qy[i] = q.y; qz[i] = q.z; qw[i] = q.w;
+        sx[i] = s.x; sy[i] = s.y; sz[i] = s.z;
+    }
+};
+
+// many 4x4 matrices, one array per element; element (column c, row r) is m[c * 4 + r]
+struct MatrixSoA
+{
+    FloatArray m[16];
+    size_t count = 0;
+
+    void resize(size_t n)
+    {
+        count = n;
+        for (FloatArray& element : m)
+            element.resize(batch_detail::padded(n), 0.0f);
+    }
+
+    glm::mat4 get(size_t i) const
+    {
+        glm::mat4 matrix;
+        for (int e = 0; e < 16; e++)
+            matrix[e / 4][e % 4] = m[e][i];
+        return matrix;
+    }
+};
+
+// Matrix work for whole arrays of objects at once, LANES objects per instruction.
+// composeQuaternions() writes T * R(q) * S straight from the components;
+// multiply() puts one matrix (typically viewProjection) in front of all of them,
+// or multiplies two arrays pair by pair, which is how TransformStore puts the
+// parents' world matrices in front of the local ones; unpack() transposes the
+// result into glm::mat4s ready for a single buffer upload and gather() goes the
+// other way.
+class BatchTransform
+{
+public:
+    // T * R(q) * S of the transforms [first, last); first is a multiple of LANES,
+    // out is already sized for in
+    // ------------------------------------------------------------------------
+    static void composeQuaternions(const QuaternionSoA& in, MatrixSoA& out, size_t first, size_t last)
+    {
+        using namespace batch_detail;
+        Lane zero = splat(0.0f), one = splat(1.0f), two = splat(2.0f);
+        for (size_t i = first; i < padded(last); i += LANES)
+        {
+            Lane x = load(&in.qx[i]), y = load(&in.qy[i]), z = load(&in.qz[i]), w = load(&in.qw[i]);
+            Lane sx = load(&in.sx[i]), sy = load(&in.sy[i]), sz = load(&in.sz[i]);
+            Lane x2 = mul(two, x), y2 = mul(two, y), z2 = mul(two, z);
+            Lane xx = mul(x, x2), yy = mul(y, y2), zz = mul(z, z2);
+            Lane xy = mul(x, y2), xz = mul(x, z2), yz = mul(y, z2);
+            Lane wx = mul(w, x2), wy = mul(w, y2), wz = mul(w, z2);
+
+            store(&out.m[0][i], mul(sub(one, add(yy, zz)), sx));
+            store(&out.m[1][i], mul(add(xy, wz), sx));
+            store(&out.m[2][i], mul(sub(xz, wy), sx));
+            store(&out.m[3][i], zero);
+            store(&out.m[4][i], mul(sub(xy, wz), sy));
+            store(&out.m[5][i], mul(sub(one, add(xx, zz)), sy));
+            store(&out.m[6][i], mul(add(yz, wx), sy));
+            store(&out.m[7][i], zero);
+            store(&out.m[8][i], mul(add(xz, wy), sz));
+            store(&out.m[9][i], mul(sub(yz, wx), sz));
+            store(&out.m[10][i], mul(sub(one, add(xx, yy)), sz));
+            store(&out.m[11][i], zero);
+            store(&out.m[12][i], load(&in.tx[i]));
+            store(&out.m[13][i], load(&in.ty[i]));
+            store(&out.m[14][i], load(&in.tz[i]));
+            store(&out.m[15][i], one);
+        }
+    }
+
+    // out = left * in for every matrix; out must not be in
+    // ------------------------------------------------------------------------
+    static void multiply(const glm::mat4& left, const MatrixSoA& in, MatrixSoA& out)
+    {
+        using namespace batch_detail;
+        out.resize(in.count);
+        size_t lanes = padded(in.count);
+        for (size_t i = 0; i < lanes; i += LANES)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                Lane x = load(&in.m[c * 4 + 0][i]), y = load(&in.m[c * 4 + 1][i]);
+                Lane z = load(&in.m[c * 4 + 2][i]), w = load(&in.m[c * 4 + 3][i]);
+                for (int r = 0; r < 4; r++)
+                {
+                    Lane sum = add(add(mul(splat(left[0][r]), x), mul(splat(left[1][r]), y)),
+                        add(mul(splat(left[2][r]), z), mul(splat(left[3][r]), w)));
+                    store(&out.m[c * 4 + r][i], sum);
+                }
+            }
+        }
+    }
+
+    // out[i] = left[i] * right[i] for i in [first, last); first is a multiple of
+    // LANES, all three are already sized and out is neither input
+    // ------------------------------------------------------------------------
+    static void multiply(const MatrixSoA& left, const MatrixSoA& right, MatrixSoA& out, size_t first, size_t last)
+    {
+        using namespace batch_detail;
+        for (size_t i = first; i < padded(last); i += LANES)
+        {
+            Lane l[16];
+            for (int e = 0; e < 16; e++)
+                l[e] = load(&left.m[e][i]);
+            for (int c = 0; c < 4; c++)
+            {
+                Lane x = load(&right.m[c * 4 + 0][i]), y = load(&right.m[c * 4 + 1][i]);
+                Lane z = load(&right.m[c * 4 + 2][i]), w = load(&right.m[c * 4 + 3][i]);
+                for (int r = 0; r < 4; r++)
+                {
+                    Lane sum = add(add(mul(l[r], x), mul(l[4 + r], y)), add(mul(l[8 + r], z), mul(l[12 + r], w)));
+                    store(&out.m[c * 4 + r][i], sum);
+                }
+            }
+        }
+    }
+
+    // back to one glm::mat4 per object, four objects per 4x4 transpose
+    // ------------------------------------------------------------------------
+    static void unpack(const MatrixSoA& in, glm::mat4* out)
+    {
+        unpack(in, out, 0, in.count);
+    }
+
+    // the same for the matrices [first, last) only, into out[first, last)
+    static void unpack(const MatrixSoA& in, glm::mat4* out, size_t first, size_t last)
+    {
+        size_t i = first;
+#if defined(BATCH_TRANSFORM_AVX) || defined(BATCH_TRANSFORM_SSE)
+        for (; i + 4 <= last; i += 4)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                __m128 r0 = _mm_loadu_ps(&in.m[c * 4 + 0][i]), r1 = _mm_loadu_ps(&in.m[c * 4 + 1][i]);
+                __m128 r2 = _mm_loadu_ps(&in.m[c * 4 + 2][i]), r3 = _mm_loadu_ps(&in.m[c * 4 + 3][i]);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(&out[i + 0][c][0], r0);
+                _mm_storeu_ps(&out[i + 1][c][0], r1);
+                _mm_storeu_ps(&out[i + 2][c][0], r2);
+                _mm_storeu_ps(&out[i + 3][c][0], r3);
+            }
+        }
+#endif
+        for (; i < last; i++)
+            out[i] = in.get(i);
+    }
+
+    // the reverse of unpack(): *matrices[i - first] into out for i in [first, last),
+    // so the matrices can be scattered over memory
+    // ------------------------------------------------------------------------
+    static void gather(const glm::mat4* const* matrices, MatrixSoA& out, size_t first, size_t last)
+    {
+        size_t i = first;
+#if defined(BATCH_TRANSFORM_AVX) || defined(BATCH_TRANSFORM_SSE)
+        for (; i + 4 <= last; i += 4)
+        {
+            const glm::mat4* const* group = matrices + (i - first);
+            for (int c = 0; c < 4; c++)
+            {
+                __m128 r0 = _mm_loadu_ps(&(*group[0])[c][0]), r1 = _mm_loadu_ps(&(*group[1])[c][0]);
+                __m128 r2 = _mm_loadu_ps(&(*group[2])[c][0]), r3 = _mm_loadu_ps(&(*group[3])[c][0]);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(&out.m[c * 4 + 0][i], r0);
+                _mm_storeu_ps(&out.m[c * 4 + 1][i], r1);
+                _mm_storeu_ps(&out.m[c * 4 + 2][i], r2);
+                _mm_storeu_ps(&out.m[c * 4 + 3][i], r3);
+            }
+        }
+#endif
+        for (; i < last; i++)
+            for (int e = 0; e < 16; e++)
+                out.m[e][i] = (*matrices[i - first])[e / 4][e % 4];
+    }
+};
+
+#endif
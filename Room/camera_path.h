@@ -0,0 +1,106 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include "camera.h"
+#include <glm/glm.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// one pose on a scripted camera path
+struct CameraKey
+{
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// Piecewise linear camera path through a list of key poses, sampled at t in [0, 1]
+// with the keys spread evenly over the range. Used by headless renders to
+// produce the same walkthrough on every run.
+class CameraPath
+{
+public:
+    std::vector<CameraKey> keys;
+
+    // text file with one "x y z yaw pitch" key per line, '#' starts a comment
+    // ------------------------------------------------------------------------
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cout << "Cannot open camera path " << path << std::endl;
+            return false;
+        }
+        keys.clear();
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos)
+                line.erase(comment);
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+            std::istringstream in(line);
+            CameraKey key;
+            if (!(in >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch))
+            {
+                std::cout << path << ":" << lineNumber << ": expected x y z yaw pitch" << std::endl;
+                return false;
+            }
+            keys.push_back(key);
+        }
+        if (keys.empty())
+        {
+            std::cout << path << ": camera path has no keys" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // the default walkthrough: dining room, through the door into the bedroom, then room3
+    // ------------------------------------------------------------------------
+    static CameraPath walkthrough()
+    {
+        CameraPath path;
+        path.keys = {
+            { glm::vec3(-3.0f, 2.5f, 4.3f),  0.0f,   0.0f },
+            { glm::vec3(3.0f, 2.5f, 5.0f),   20.0f, -10.0f },
+            { glm::vec3(6.0f, 2.2f, 1.1f),   0.0f,   0.0f },
+            { glm::vec3(11.5f, 2.2f, 1.1f),  35.0f, -5.0f },
+            { glm::vec3(16.0f, 2.5f, 5.0f),  90.0f, -15.0f },
+            { glm::vec3(11.0f, 2.2f, 1.5f),  200.0f, -5.0f },
+            { glm::vec3(11.0f, 2.2f, -2.5f), 300.0f, -10.0f },
+        };
+        return path;
+    }
+
+    CameraKey sample(float t) const
+    {
+        if (keys.size() == 1 || t <= 0.0f)
+            return keys.front();
+        if (t >= 1.0f)
+            return keys.back();
+        float segment = t * (keys.size() - 1);
+        int index = (int)segment;
+        float f = segment - index;
+        const CameraKey& a = keys[index];
+        const CameraKey& b = keys[index + 1];
+        return { a.position + (b.position - a.position) * f, a.yaw + (b.yaw - a.yaw) * f, a.pitch + (b.pitch - a.pitch) * f };
+    }
+
+    // pose the camera at frame `frame` of `frameCount` evenly spaced frames
+    void apply(Camera& camera, int frame, int frameCount) const
+    {
+        CameraKey key = sample(frameCount > 1 ? (float)frame / (frameCount - 1) : 0.0f);
+        camera.SetPose(key.position, key.yaw, key.pitch);
+    }
+};
+
+#endif
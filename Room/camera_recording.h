@@ -0,0 +1,111 @@
+#ifndef CAMERA_RECORDING_H
+#define CAMERA_RECORDING_H
+
+#include "camera.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// camera input of one frame: a bit per Camera_Movement that was held plus the mouse offset
+struct CameraInput
+{
+    unsigned int movement = 0;
+    float mouseX = 0.0f, mouseY = 0.0f;
+};
+
+// Per-frame camera input captured from the keyboard/mouse handlers and replayed
+// through Camera::ProcessKeyboard/ProcessMouseMovement with a fixed timestep, so
+// a benchmark walks exactly the same path on every machine.
+class CameraRecording
+{
+public:
+    std::vector<CameraInput> frames;
+
+    // text file, one "movement-bits mouse-x mouse-y" line per frame
+    // ------------------------------------------------------------------------
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cout << "Cannot open camera recording " << path << std::endl;
+            return false;
+        }
+        frames.clear();
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream in(line);
+            CameraInput input;
+            if (!(in >> input.movement >> input.mouseX >> input.mouseY))
+            {
+                std::cout << path << ":" << lineNumber << ": expected movement-bits mouse-x mouse-y" << std::endl;
+                return false;
+            }
+            frames.push_back(input);
+        }
+        if (frames.empty())
+        {
+            std::cout << path << ": recording has no frames" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool save(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cout << "Cannot write " << path << std::endl;
+            return false;
+        }
+        file << "# camera input recording: movement-bits mouse-x mouse-y per frame\n";
+        for (const CameraInput& input : frames)
+            file << input.movement << " " << input.mouseX << " " << input.mouseY << "\n";
+        return true;
+    }
+
+    // default flythrough from the start position: across the dining room, a look
+    // around, through the door into the bedroom and back
+    // ------------------------------------------------------------------------
+    static CameraRecording flythrough()
+    {
+        CameraRecording recording;
+        auto hold = [&](int count, unsigned int movement, float mouseX, float mouseY) {
+            CameraInput input;
+            input.movement = movement;
+            input.mouseX = mouseX;
+            input.mouseY = mouseY;
+            recording.frames.insert(recording.frames.end(), count, input);
+        };
+        hold(150, 1u << FORWARD, 0.0f, 0.0f);
+        hold(60, 0, -6.0f, -1.0f);
+        hold(60, 1u << RIGHT, 12.0f, 1.0f);
+        hold(120, 1u << FORWARD, 0.0f, 0.0f);
+        hold(60, 1u << Y_LEFT, 0.0f, 0.0f);
+        hold(90, 1u << BACKWARD | 1u << LEFT, -4.0f, 0.0f);
+        hold(60, 1u << UP, 0.0f, -3.0f);
+        return recording;
+    }
+
+    // apply frame `frame` (wrapping around) as if it took `dt` seconds
+    void apply(Camera& camera, int frame, float dt) const
+    {
+        const CameraInput& input = frames[frame % frames.size()];
+        for (int m = FORWARD; m <= R_RIGHT; m++)
+            if (input.movement & (1u << m))
+                camera.ProcessKeyboard((Camera_Movement)m, dt);
+        if (input.mouseX != 0.0f || input.mouseY != 0.0f)
+            camera.ProcessMouseMovement(input.mouseX, input.mouseY);
+    }
+};
+
+#endif
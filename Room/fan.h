@@ -2,82 +2,59 @@
 #define fan_h
 
 #include "shader.h"
+#include "scene_graph.h"
+#include "transform_store.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
-#include <vector>
 
+// Ceiling fan rig. The hub sits at the centre of the blades in the scene's
+// TransformStore with the four blades as its children, so turning the fan only
+// rewrites the hub's rotation and the store recomputes the hub and blade world
+// matrices, without heap allocation and without copying the Shader. The hub is a
+// child of the fan body's root transform, so moving the body carries the blades.
 class Fan {
 
 public:
-	std::vector<glm::mat4> modelMatrices;
-	float tox, toy, toz;
-	Fan(float x = 0, float y = 0, float z = 0) {
-		tox = x;
-		toy = y;
-		toz = z;
+	static const int BLADES = 4;
+	// farthest a blade corner gets from the hub
+	static constexpr float REACH = 2.4f;
+	int hub;
+	int blades[BLADES];
+	// parent: the transform the hub hangs from, -1 for none; pivot is relative to it
+	Fan(TransformStore& transforms, int parent, const glm::vec3& pivot) {
+		// all blades are the unit cube scaled out from the same corner
+		static const glm::vec3 bladeScales[BLADES] = {
+			glm::vec3(-4.75f, -.05f, 1.0f), glm::vec3(4.75f, -.05f, -1.0f),
+			glm::vec3(-3.0f, -.05f, -2.75f), glm::vec3(3.0f, -.05f, 2.75f)
+		};
+		hub = transforms.add(parent, pivot, glm::quat(), glm::vec3(1.0f));
+		for (int i = 0; i < BLADES; i++)
+			blades[i] = transforms.add(hub, glm::vec3(0.0f), glm::quat(), bladeScales[i]);
+		posedAngle = 0.0f;
 	}
-	glm::mat4 transforamtion(float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz) {
-		tx += tox;
-		ty += toy;
-		tz += toz;
-		glm::mat4 identityMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-		glm::mat4 translateMatrix, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix, model;
-		translateMatrix = glm::translate(identityMatrix, glm::vec3(tx, ty, tz));
-		rotateXMatrix = glm::rotate(identityMatrix, glm::radians(rx), glm::vec3(2.0f, 2.0f, 0.0f));
-		rotateYMatrix = glm::rotate(identityMatrix, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-		rotateZMatrix = glm::rotate(identityMatrix, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
-		scaleMatrix = glm::scale(identityMatrix, glm::vec3(sx, sy, sz));
-		model = translateMatrix * rotateXMatrix * rotateYMatrix * rotateZMatrix * scaleMatrix;
-		return model;
+	// turn the hub about its Y axis; nothing to do if the angle did not change
+	void update(TransformStore& transforms, float angle) {
+		if (angle == posedAngle)
+			return;
+		posedAngle = angle;
+		transforms.setRotation(hub, glm::angleAxis(glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f)));
 	}
 
-	Shader local_rotation(Shader ourShader, unsigned int VAOF3, float angle = 0) {
-		glm::mat4 model;
-		float rotateAngle_X = 0;
-		float rotateAngle_Y = 0;
-		float rotateAngle_Z = 0;
-
-		model = transforamtion(5.25, 4.25, 5.25, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -4.75, -.05, 1);
-		modelMatrices.push_back(model);
-		
-		model = transforamtion(5.25, 4.25, 5.25, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 4.75, -.05, -1);
-		modelMatrices.push_back(model);
-
-		model = transforamtion(5.25, 4.25, 5.25, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, -.05, -2.75);
-		modelMatrices.push_back(model);
-
-		model = transforamtion(5.25, 4.25, 5.25, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 3, -.05, 2.75);
-		modelMatrices.push_back(model);
-
-
-		unsigned int vertex_array[] = { VAOF3, VAOF3, VAOF3, VAOF3 };
-		glm::vec3 averagePosition(0.0f);
-		for (const glm::mat4& model : modelMatrices) {
-			averagePosition += glm::vec3(model[3]);
+	void draw(const Shader& ourShader, UniformHandle model, UniformHandle normalMatrix, const TransformStore& transforms, const MeshArena& arena, const Mesh& blade) const {
+		for (int i = 0; i < BLADES; i++) {
+			ourShader.setMat4(model, transforms.world[blades[i]]);
+			ourShader.setMat3(normalMatrix, glm::transpose(glm::inverse(glm::mat3(transforms.world[blades[i]]))));
+			SceneGraph::drawMesh(arena, blade);
 		}
-
-		averagePosition /= modelMatrices.size();
-
-		glm::mat4 moveToOrigin = glm::translate(glm::mat4(1.0f), -averagePosition);
-		glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
-		glm::mat4 moveToOriginalPosition = glm::translate(glm::mat4(1.0f), averagePosition);
-		glm::mat4 groupTransform = moveToOriginalPosition * rotation * moveToOrigin;
-
-		int i = 0;
-		for (glm::mat4& model : modelMatrices) {
-
-			model = groupTransform * model;
-			ourShader.setMat4("model", model);
-			glBindVertexArray(vertex_array[i]);
-			glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-			i++;
-		}
-		return ourShader;
 	}
+
+private:
+	float posedAngle;
 };
 
 
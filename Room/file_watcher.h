@@ -0,0 +1,129 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+// Reports files that were written since the last poll(). On Linux an inotify watch
+// on each file's directory catches both in-place writes and the write-and-rename
+// most editors do; elsewhere the modification times are compared on every poll.
+// poll() never blocks, so it can run once per frame.
+class FileWatcher
+{
+public:
+    FileWatcher()
+    {
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    ~FileWatcher()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool watch(const std::string& path)
+    {
+        Entry entry;
+        entry.path = path;
+        size_t slash = path.find_last_of("/\\");
+        entry.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+        entry.name = slash == std::string::npos ? path : path.substr(slash + 1);
+#ifdef __linux__
+        if (fd < 0)
+            return false;
+        entry.watch = inotify_add_watch(fd, entry.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (entry.watch < 0)
+            return false;
+#else
+        entry.modified = modificationTime(path);
+#endif
+        entries.push_back(entry);
+        return true;
+    }
+
+    // watched paths changed since the last call, each listed once
+    // ------------------------------------------------------------------------
+    std::vector<std::string> poll()
+    {
+        std::vector<std::string> changed;
+#ifdef __linux__
+        alignas(struct inotify_event) char buffer[4096];
+        while (fd >= 0)
+        {
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0)
+                break;
+            for (char* p = buffer; p < buffer + length; )
+            {
+                const struct inotify_event* event = (const struct inotify_event*)p;
+                p += sizeof(struct inotify_event) + event->len;
+                if (event->len == 0)
+                    continue;
+                for (const Entry& entry : entries)
+                    if (entry.watch == event->wd && entry.name == event->name)
+                        addOnce(changed, entry.path);
+            }
+        }
+#else
+        for (Entry& entry : entries)
+        {
+            long long modified = modificationTime(entry.path);
+            if (modified != entry.modified)
+            {
+                entry.modified = modified;
+                addOnce(changed, entry.path);
+            }
+        }
+#endif
+        return changed;
+    }
+
+private:
+    struct Entry
+    {
+        std::string path, directory, name;
+        int watch = -1;
+        long long modified = 0;
+    };
+    std::vector<Entry> entries;
+#ifdef __linux__
+    int fd = -1;
+#else
+    static long long modificationTime(const std::string& path)
+    {
+#ifdef _WIN32
+        struct _stat info;
+        return _stat(path.c_str(), &info) == 0 ? (long long)info.st_mtime : 0;
+#else
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 ? (long long)info.st_mtime : 0;
+#endif
+    }
+#endif
+
+    static void addOnce(std::vector<std::string>& paths, const std::string& path)
+    {
+        for (const std::string& p : paths)
+            if (p == path)
+                return;
+        paths.push_back(path);
+    }
+};
+
+#endif
@@ -1,9 +1,115 @@
 #version 330 core
 in vec4 color;
+in vec3 worldPos;
+in vec3 normal;
+flat in uvec4 lights;
 
 out vec4 FragColor;
 
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    float time;
+};
+
+// every light of the scene (LightUniforms); position.w is the range, negative for
+// a directional light, direction.w the cosine of the outer cone and color.w the
+// cosine of the inner cone (-2 and -1 for point lights)
+struct Light
+{
+    vec4 position;
+    vec4 direction;
+    vec4 color;
+};
+
+layout (std140) uniform LightData
+{
+    vec4 ambient;
+    vec4 specular;      // strength, shininess
+    Light sceneLights[256];
+};
+
+// the overlay and anything else drawn in pixel space
+uniform bool unlit;
+
+#ifdef CLUSTERED
+// clustered lighting (LightClusters): per-cluster headers, first index << 9 |
+// count, then the light indices; the header after the last cluster lists the
+// lights of every fragment. The plain program uses the object's own list and
+// carries none of this: the software rasterizers run both sides of a branch.
+uniform usamplerBuffer clusterLights;
+uniform vec3 clusterGrid;       // tiles across, tiles up, depth slices
+uniform vec4 clusterScale;      // tiles per pixel across and up, slices per log depth, log(slicing start) times slices per log depth
+#endif
+
+// Blinn-Phong contribution of one light
+vec3 shade(Light light, vec3 N, vec3 V, vec3 base)
+{
+    vec3 L;
+    float attenuation = 1.0f;
+    if (light.position.w < 0.0f)
+        L = -light.direction.xyz;
+    else
+    {
+        vec3 toLight = light.position.xyz - worldPos;
+        float d = length(toLight);
+        L = toLight / d;
+        // inverse square, windowed to reach zero at the range
+        float ratio = d / light.position.w;
+        float window = clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+        attenuation = window * window / (1.0f + d * d)
+            * smoothstep(light.direction.w, light.color.w, dot(-L, light.direction.xyz));
+    }
+    float diffuse = max(dot(N, L), 0.0f);
+    if (diffuse <= 0.0f || attenuation <= 0.0f)
+        return vec3(0.0f);
+    vec3 H = normalize(L + V);
+    float highlight = specular.x * pow(max(dot(N, H), 0.0f), specular.y);
+    return light.color.rgb * attenuation * (diffuse * base + highlight);
+}
+
+#ifdef CLUSTERED
+// the lights of one header of the cluster buffer
+vec3 shadeRange(uint header, vec3 N, vec3 V, vec3 base)
+{
+    vec3 result = vec3(0.0f);
+    int first = int(header >> 9u);
+    int count = int(header & 0x1FFu);
+    for (int i = 0; i < count; i++)
+        result += shade(sceneLights[texelFetch(clusterLights, first + i).r], N, V, base);
+    return result;
+}
+#endif
+
 void main()
 {
-    FragColor = color;
+    vec3 base = color.rgb;
+    // geometry without normals, such as lines, keeps its flat colour
+    if (unlit || dot(normal, normal) == 0.0f)
+    {
+        FragColor = color;
+        return;
+    }
+    vec3 N = normalize(normal);
+    vec3 V = normalize(cameraPosition - worldPos);
+    vec3 result = base * ambient.rgb;
+
+#ifdef CLUSTERED
+    float depth = -(view * vec4(worldPos, 1.0f)).z;
+    vec3 cell = vec3(gl_FragCoord.xy * clusterScale.xy, log(depth) * clusterScale.z - clusterScale.w);
+    ivec3 c = ivec3(clamp(cell, vec3(0.0f), clusterGrid - 1.0f));
+    int grid = int(clusterGrid.x * clusterGrid.y * clusterGrid.z);
+    result += shadeRange(texelFetch(clusterLights, grid).r, N, V, base);
+    result += shadeRange(texelFetch(clusterLights, (c.z * int(clusterGrid.y) + c.y) * int(clusterGrid.x) + c.x).r, N, V, base);
+#else
+    // only the lights of this object's list: byte 0 is the count, the light
+    // indices follow; the loop runs exactly that many times
+    uint count = lights.x & 0xFFu;
+    for (uint i = 1u; i <= count; i++)
+        result += shade(sceneLights[(lights[i >> 2u] >> (8u * (i & 3u))) & 0xFFu], N, V, base);
+#endif
+    FragColor = vec4(result, color.a);
 }
@@ -0,0 +1,245 @@
+#ifndef FRAME_TIMER_H
+#define FRAME_TIMER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// columns of a frame sample: the CPU phases of the render loop in loop order,
+// then the CPU total and the GPU time of the frame's draw work
+enum TimerColumn {
+    T_INPUT,
+    T_MATRICES,
+    T_UNIFORMS,
+    T_DRAW,
+    T_SWAP,
+    T_CPU_TOTAL,
+    T_GPU,
+    T_COLUMNS
+};
+
+const char* const TIMER_COLUMN_NAMES[T_COLUMNS] = { "input", "matrices", "uniforms", "draw", "swap", "cpu_total", "gpu" };
+
+struct FrameSample
+{
+    float ms[T_COLUMNS];    // T_GPU stays negative until its query result arrives
+};
+
+struct Percentiles
+{
+    float p50, p95, p99;
+};
+
+// Records CPU time per render-loop phase and GPU time per frame. A phase is closed
+// by mark(), which charges the time since the previous mark to it. GPU time comes
+// from a GL_TIME_ELAPSED query spanning the whole frame, from beginGpu() before the
+// clear to endFrame() after the swap or finish. The queries are kept in a ring and
+// a result is only read once GL_QUERY_RESULT_AVAILABLE is set, a few frames late;
+// a frame whose ring slot is still busy goes without a GPU time rather than stall.
+// Percentiles are taken over the last `window` frames; the full history is kept
+// for export.
+class FrameTimer
+{
+public:
+    static const int QUERY_RING = 4;
+    int window = 240;
+    std::vector<FrameSample> history;
+    int skippedQueries = 0;         // frames not measured because their slot was busy
+
+    void init()
+    {
+        glGenQueries(QUERY_RING, queries);
+        for (int q = 0; q < QUERY_RING; q++)
+            queryFrame[q] = -1;
+        // llvmpipe reports garbage for the first elapsed-time query that contains
+        // rendering, so spend it on a clear before the first real frame
+        GLuint64 ignored;
+        glBeginQuery(GL_TIME_ELAPSED, queries[0]);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glEndQuery(GL_TIME_ELAPSED);
+        glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &ignored);
+    }
+
+    void beginFrame()
+    {
+        FrameSample sample;
+        for (int c = 0; c < T_COLUMNS; c++)
+            sample.ms[c] = 0.0f;
+        sample.ms[T_GPU] = -1.0f;
+        history.push_back(sample);
+        frameStart = lastMark = Clock::now();
+    }
+
+    void mark(TimerColumn phase)
+    {
+        Clock::time_point now = Clock::now();
+        history.back().ms[phase] += std::chrono::duration<float, std::milli>(now - lastMark).count();
+        lastMark = now;
+    }
+
+    // start the frame's query before its first GL command; endFrame() ends it
+    // ------------------------------------------------------------------------
+    void beginGpu()
+    {
+        int slot = (int)(history.size() % QUERY_RING);
+        if (queryFrame[slot] >= 0 && !available(slot))
+        {
+            skippedQueries++;
+            return;
+        }
+        if (queryFrame[slot] >= 0)
+            collect(slot);
+        glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+        queryFrame[slot] = (int)history.size() - 1;
+        queryOpen = true;
+    }
+
+    void endFrame()
+    {
+        if (queryOpen)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            queryOpen = false;
+        }
+        FrameSample& sample = history.back();
+        sample.ms[T_CPU_TOTAL] = std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count();
+        // pick up every query that finished without waiting
+        for (int q = 0; q < QUERY_RING; q++)
+        {
+            if (queryFrame[q] >= 0 && available(q))
+                collect(q);
+        }
+    }
+
+    // wait for the queries still in flight, call before exporting
+    void finish()
+    {
+        for (int q = 0; q < QUERY_RING; q++)
+            if (queryFrame[q] >= 0)
+                collect(q);
+    }
+
+    // percentiles of one column over the rolling window, frames without a value are skipped
+    // ------------------------------------------------------------------------
+    Percentiles percentiles(TimerColumn column) const
+    {
+        std::vector<float> values;
+        size_t first = history.size() > (size_t)window ? history.size() - window : 0;
+        for (size_t f = first; f < history.size(); f++)
+            if (history[f].ms[column] >= 0.0f)
+                values.push_back(history[f].ms[column]);
+        if (values.empty())
+            return { 0.0f, 0.0f, 0.0f };
+        std::sort(values.begin(), values.end());
+        auto at = [&](float p) { return values[std::min(values.size() - 1, (size_t)(p * values.size()))]; };
+        return { at(0.50f), at(0.95f), at(0.99f) };
+    }
+
+    // one row per recorded frame
+    // ------------------------------------------------------------------------
+    bool writeCSV(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cout << "Cannot write " << path << std::endl;
+            return false;
+        }
+        file << "frame";
+        for (int c = 0; c < T_COLUMNS; c++)
+            file << "," << TIMER_COLUMN_NAMES[c] << "_ms";
+        file << "\n";
+        char value[32];
+        for (size_t f = 0; f < history.size(); f++)
+        {
+            file << f;
+            for (int c = 0; c < T_COLUMNS; c++)
+            {
+                snprintf(value, sizeof(value), ",%.4f", history[f].ms[c]);
+                file << value;
+            }
+            file << "\n";
+        }
+        file.close();
+        if (!file)
+        {
+            std::cout << "Cannot write " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // rolling percentiles of every column
+    // ------------------------------------------------------------------------
+    bool writeJSON(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cout << "Cannot write " << path << std::endl;
+            return false;
+        }
+        file << "{\n  \"frames\": " << history.size() << ",\n  \"window\": " << window << ",\n  \"ms\": {\n";
+        char line[160];
+        for (int c = 0; c < T_COLUMNS; c++)
+        {
+            Percentiles p = percentiles((TimerColumn)c);
+            snprintf(line, sizeof(line), "    \"%s\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f }%s\n",
+                TIMER_COLUMN_NAMES[c], p.p50, p.p95, p.p99, c + 1 < T_COLUMNS ? "," : "");
+            file << line;
+        }
+        file << "  }\n}\n";
+        file.close();
+        if (!file)
+        {
+            std::cout << "Cannot write " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void printSummary() const
+    {
+        std::cout << "frame times over the last " << std::min((int)history.size(), window) << " frames (ms, p50/p95/p99)" << std::endl;
+        for (int c = 0; c < T_COLUMNS; c++)
+        {
+            Percentiles p = percentiles((TimerColumn)c);
+            printf("  %-10s %8.3f %8.3f %8.3f\n", TIMER_COLUMN_NAMES[c], p.p50, p.p95, p.p99);
+        }
+    }
+
+    void release()
+    {
+        glDeleteQueries(QUERY_RING, queries);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point frameStart, lastMark;
+    unsigned int queries[QUERY_RING] = {};
+    int queryFrame[QUERY_RING];     // history index the slot measures, -1 when free
+    bool queryOpen = false;
+
+    bool available(int slot) const
+    {
+        GLint ready = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &ready);
+        return ready != 0;
+    }
+
+    void collect(int slot)
+    {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &ns);
+        history[queryFrame[slot]].ms[T_GPU] = ns / 1.0e6f;
+        queryFrame[slot] = -1;
+    }
+};
+
+#endif
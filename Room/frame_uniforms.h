@@ -0,0 +1,57 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include "shader.h"
+#include "render_stats.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// std140 layout of the FrameData block in vertexShader.vs; the vec3 takes a 16
+// byte slot and time fills its last four bytes
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec3 cameraPosition;
+    float time;
+};
+static_assert(sizeof(FrameData) == 208, "FrameData must match the std140 block");
+
+// Camera data of the current frame in one uniform buffer, bound once at
+// FRAME_DATA_BINDING and read by every program that declares the FrameData
+// block. update() rewrites the whole block with a single glBufferSubData.
+class FrameUniforms
+{
+public:
+    unsigned int ubo = 0;
+    FrameData data;
+
+    void init()
+    {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, ubo);
+    }
+
+    // ------------------------------------------------------------------------
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float time)
+    {
+        data.view = view;
+        data.projection = projection;
+        data.viewProjection = projection * view;
+        data.cameraPosition = cameraPosition;
+        data.time = time;
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+        countStateChange(2);
+    }
+
+    void release()
+    {
+        glDeleteBuffers(1, &ubo);
+    }
+};
+
+#endif
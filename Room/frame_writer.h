@@ -0,0 +1,157 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Writes RGB frames (top row first, 3 bytes per pixel) as binary PPM or as PNG.
+// The PNG is stored uncompressed (deflate "stored" blocks) so no zlib is needed;
+// the files are larger but every image viewer and diff tool reads them.
+
+// expand a printf-style pattern such as "frames/frame_%04d.png" for one frame
+// ------------------------------------------------------------------------
+inline std::string framePath(const std::string& pattern, int frame)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), pattern.c_str(), frame);
+    return path;
+}
+
+inline bool writePPM(const std::string& path, int width, int height, const std::vector<unsigned char>& rgb)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "Cannot write " << path << std::endl;
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    file.write((const char*)rgb.data(), rgb.size());
+    file.close();
+    if (!file)
+    {
+        std::cout << "Cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+namespace png_detail
+{
+    inline unsigned int crc32(const unsigned char* data, size_t size, unsigned int crc = 0)
+    {
+        static unsigned int table[256];
+        static bool tableReady = false;
+        if (!tableReady)
+        {
+            for (unsigned int n = 0; n < 256; n++)
+            {
+                unsigned int c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[n] = c;
+            }
+            tableReady = true;
+        }
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    inline void putU32(std::vector<unsigned char>& out, unsigned int v)
+    {
+        out.push_back((unsigned char)(v >> 24));
+        out.push_back((unsigned char)(v >> 16));
+        out.push_back((unsigned char)(v >> 8));
+        out.push_back((unsigned char)v);
+    }
+
+    inline void writeChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data)
+    {
+        std::vector<unsigned char> chunk;
+        putU32(chunk, (unsigned int)data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        putU32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+        file.write((const char*)chunk.data(), chunk.size());
+    }
+}
+
+inline bool writePNG(const std::string& path, int width, int height, const std::vector<unsigned char>& rgb)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "Cannot write " << path << std::endl;
+        return false;
+    }
+    static const char signature[8] = { (char)0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(signature, 8);
+
+    std::vector<unsigned char> header;
+    png_detail::putU32(header, width);
+    png_detail::putU32(header, height);
+    header.push_back(8);        // bit depth
+    header.push_back(2);        // colour type RGB
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    png_detail::writeChunk(file, "IHDR", header);
+
+    // scanlines with filter byte 0, wrapped in a zlib stream of stored blocks
+    size_t row = (size_t)width * 3;
+    std::vector<unsigned char> raw;
+    raw.reserve((row + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb.begin() + y * row, rgb.begin() + (y + 1) * row);
+    }
+
+    std::vector<unsigned char> zlib;
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    unsigned int a = 1, b = 0;
+    for (size_t pos = 0; pos < raw.size(); )
+    {
+        size_t size = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+        zlib.push_back(pos + size == raw.size() ? 1 : 0);
+        zlib.push_back((unsigned char)size);
+        zlib.push_back((unsigned char)(size >> 8));
+        zlib.push_back((unsigned char)~size);
+        zlib.push_back((unsigned char)(~size >> 8));
+        for (size_t i = pos; i < pos + size; i++)
+        {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + size);
+        pos += size;
+    }
+    png_detail::putU32(zlib, (b << 16) | a);
+    png_detail::writeChunk(file, "IDAT", zlib);
+    png_detail::writeChunk(file, "IEND", std::vector<unsigned char>());
+    file.close();
+    if (!file)
+    {
+        std::cout << "Cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// pick the format from the file extension, PPM unless it ends in .png
+// ------------------------------------------------------------------------
+inline bool writeFrame(const std::string& path, int width, int height, const std::vector<unsigned char>& rgb)
+{
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".png") == 0)
+        return writePNG(path, width, height, rgb);
+    return writePPM(path, width, height, rgb);
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+#include "scene_graph.h"
+#include "render_stats.h"
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_SSE 1
+#endif
+
+// Rejects scene nodes whose world-space bounding box lies entirely outside the view
+// frustum. Boxes are kept as structure-of-arrays centre/half-extent lanes padded
+// to a multiple of four, so the six plane tests run on four boxes per SSE
+// instruction. Boxes are rebuilt only when the scene version changes.
+class FrustumCuller
+{
+public:
+    std::vector<unsigned char> visible;     // one flag per scene node, filled by cull()
+    int visibleCount = 0;
+
+    // world boxes for every node from the mesh's object-space box and the node's world matrix
+    // ------------------------------------------------------------------------
+    void update(const SceneGraph& scene)
+    {
+        if (scene.version == builtVersion)
+            return;
+        builtVersion = scene.version;
+
+        int count = (int)scene.nodes.size();
+        int padded = (count + 3) & ~3;
+        for (int lane = 0; lane < 6; lane++)
+            boxes[lane].assign(padded, 0.0f);   // padding lanes are tested but never read back
+
+        for (int n = 0; n < count; n++)
+        {
+            const SceneNode& node = scene.nodes[n];
+            const Mesh& mesh = scene.meshes[node.mesh];
+            glm::vec3 center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+            glm::vec3 extent = (mesh.boundsMax - mesh.boundsMin) * 0.5f;
+            const glm::mat4& m = scene.world(node);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                boxes[axis][n] = m[0][axis] * center.x + m[1][axis] * center.y + m[2][axis] * center.z + m[3][axis];
+                boxes[3 + axis][n] = std::fabs(m[0][axis]) * extent.x + std::fabs(m[1][axis]) * extent.y + std::fabs(m[2][axis]) * extent.z;
+            }
+        }
+        visible.assign(count, 1);
+        visibleCount = count;
+    }
+
+    // left, right, bottom, top, near, far; a point p is inside when dot(plane, (p, 1)) >= 0
+    // ------------------------------------------------------------------------
+    static void extractPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+    {
+        glm::vec4 w(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+        for (int i = 0; i < 3; i++)
+        {
+            glm::vec4 row(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+            planes[2 * i] = w + row;
+            planes[2 * i + 1] = w - row;
+        }
+    }
+
+    // world box of node n as centre and half extent
+    void nodeBox(int n, glm::vec3& center, glm::vec3& extent) const
+    {
+        center = glm::vec3(boxes[0][n], boxes[1][n], boxes[2][n]);
+        extent = glm::vec3(boxes[3][n], boxes[4][n], boxes[5][n]);
+    }
+
+    // scene version the boxes were built from
+    unsigned int boxesVersion() const
+    {
+        return builtVersion;
+    }
+
+    // test every box against the planes of viewProjection (Gribb/Hartmann extraction)
+    // ------------------------------------------------------------------------
+    void cull(const glm::mat4& viewProjection)
+    {
+        glm::vec4 planes[6];
+        extractPlanes(viewProjection, planes);
+
+        int count = (int)visible.size();
+        int padded = (int)boxes[0].size();
+        visibleCount = 0;
+#ifdef FRUSTUM_CULLER_SSE
+        for (int n = 0; n < padded; n += 4)
+        {
+            __m128 cx = _mm_loadu_ps(&boxes[0][n]), cy = _mm_loadu_ps(&boxes[1][n]), cz = _mm_loadu_ps(&boxes[2][n]);
+            __m128 ex = _mm_loadu_ps(&boxes[3][n]), ey = _mm_loadu_ps(&boxes[4][n]), ez = _mm_loadu_ps(&boxes[5][n]);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < 6; p++)
+            {
+                // distance of the centre plus the box's projected radius onto the normal
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes[p].x)), _mm_mul_ps(cy, _mm_set1_ps(planes[p].y))),
+                    _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(planes[p].z)), _mm_set1_ps(planes[p].w)));
+                __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::fabs(planes[p].x))), _mm_mul_ps(ey, _mm_set1_ps(std::fabs(planes[p].y)))),
+                    _mm_mul_ps(ez, _mm_set1_ps(std::fabs(planes[p].z))));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+            }
+            int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4 && n + lane < count; lane++)
+            {
+                visible[n + lane] = (mask >> lane) & 1;
+                visibleCount += visible[n + lane];
+            }
+        }
+#else
+        for (int n = 0; n < count; n++)
+        {
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; p++)
+            {
+                float d = boxes[0][n] * planes[p].x + boxes[1][n] * planes[p].y + boxes[2][n] * planes[p].z + planes[p].w;
+                float r = boxes[3][n] * std::fabs(planes[p].x) + boxes[4][n] * std::fabs(planes[p].y) + boxes[5][n] * std::fabs(planes[p].z);
+                inside = d + r >= 0.0f;
+            }
+            visible[n] = inside;
+            visibleCount += inside;
+        }
+        (void)padded;
+#endif
+        renderStats().culled += count - visibleCount;
+    }
+
+    // mark everything visible, used when culling is switched off
+    void showAll()
+    {
+        std::fill(visible.begin(), visible.end(), 1);
+        visibleCount = (int)visible.size();
+    }
+
+private:
+    unsigned int builtVersion = ~0u;
+    std::vector<float> boxes[6];    // centre x/y/z, half-extent x/y/z
+};
+
+#endif
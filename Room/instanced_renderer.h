@@ -0,0 +1,176 @@
+#ifndef INSTANCED_RENDERER_H
+#define INSTANCED_RENDERER_H
+
+#include "shader.h"
+#include "scene_graph.h"
+#include "mesh_arena.h"
+#include "render_queue.h"
+#include "light_culler.h"
+#include "render_stats.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+// per-instance attributes, read by vertexShader.vs at locations 2 (colour), 3-6
+// (model), 7-9 (normal matrix) and 10 (light list)
+struct InstanceData
+{
+    glm::vec3 color;
+    glm::mat4 model;
+    glm::mat3 normal;       // inverse transpose of the model's upper 3x3
+    GLuint lights[4];
+};
+
+// Draws the batches of a RenderQueue with one glDrawElementsInstancedBaseVertex
+// each. Instances are stored in queue order; the material colour travels with
+// the instance.
+class InstancedRenderer
+{
+public:
+    struct Bucket
+    {
+        int mesh;
+        int first;      // first instance in the instance buffer
+        int count;
+    };
+
+    unsigned int instanceVBO = 0;
+    std::vector<Bucket> buckets;
+    std::vector<InstanceData> instances;
+
+    // the instance attributes live on the arena VAO but are only enabled while drawing
+    // ------------------------------------------------------------------------
+    void init(const MeshArena& arena)
+    {
+        glGenBuffers(1, &instanceVBO);
+        arena.bind();
+        for (int i = 2; i <= 10; i++)
+            glVertexAttribDivisor(i, 1);
+    }
+
+    // take over the queue's batches, which also carry the level of detail, and
+    // upload its instances with a single buffer write when the scene version, the
+    // light lists or the nodes of a batch changed. A camera move reorders the nodes
+    // inside a batch by depth but keeps the buffer: the instances stay in the
+    // front to back order of the last upload, so a static scene uploads again
+    // only when nodes cross the frustum or switch level of detail
+    // ------------------------------------------------------------------------
+    void update(const SceneGraph& scene, const RenderQueue& queue, const LightCuller& lights)
+    {
+        if (scene.version == builtVersion && lights.version == builtLights && sameBatches(queue))
+            return;
+        builtVersion = scene.version;
+        builtLights = lights.version;
+
+        buckets.clear();
+        builtBatch.assign(scene.nodes.size(), -1);
+        for (const RenderQueue::Batch& batch : queue.batches)
+        {
+            for (int i = batch.first; i < batch.first + batch.count; i++)
+                builtBatch[queue.nodes[i]] = (int)buckets.size();
+            buckets.push_back({ batch.mesh, batch.first, batch.count });
+        }
+
+        instances.resize(queue.nodes.size());
+        for (size_t i = 0; i < queue.nodes.size(); i++)
+            instances[i] = makeInstance(scene, lights, queue.nodes[i]);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), instances.data(), GL_STATIC_DRAW);
+    }
+
+    // one instanced draw per non-empty bucket
+    // ------------------------------------------------------------------------
+    void draw(const Shader& shader, const SceneGraph& scene, const MeshArena& arena) const
+    {
+        shader.setBool(instancedFlag.get(shader), true);
+        arena.bind();
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (int i = 2; i <= 10; i++)
+            glEnableVertexAttribArray(i);
+        countStateChange(10);
+        for (const Bucket& bucket : buckets)
+        {
+            if (bucket.count == 0)
+                continue;
+            pointInstanceAttributes(bucket.first);
+            const Mesh& mesh = scene.meshes[bucket.mesh];
+            glDrawElementsInstancedBaseVertex(mesh.mode, mesh.count, arena.indexType,
+                (void*)(mesh.firstIndex * arena.indexSize()), bucket.count, mesh.baseVertex);
+            countDraw(mesh.mode, mesh.count, bucket.count);
+        }
+        for (int i = 2; i <= 10; i++)
+            glDisableVertexAttribArray(i);
+        countStateChange(9);
+        shader.setBool(instancedFlag.get(shader), false);
+    }
+
+    void release()
+    {
+        glDeleteBuffers(1, &instanceVBO);
+    }
+
+    // the instance buffer is shared by all buckets, so the attribute offsets are
+    // pointed at the bucket's range right before its draw
+    static void pointInstanceAttributes(int first)
+    {
+        size_t base = first * sizeof(InstanceData);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, color)));
+        for (int column = 0; column < 4; column++)
+        {
+            size_t offset = base + offsetof(InstanceData, model) + column * sizeof(glm::vec4);
+            glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offset);
+        }
+        for (int column = 0; column < 3; column++)
+        {
+            size_t offset = base + offsetof(InstanceData, normal) + column * sizeof(glm::vec3);
+            glVertexAttribPointer(7 + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offset);
+        }
+        glVertexAttribIPointer(10, 4, GL_UNSIGNED_INT, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, lights)));
+        countStateChange(9);
+    }
+
+    static InstanceData makeInstance(const SceneGraph& scene, const LightCuller& lights, int node)
+    {
+        InstanceData instance;
+        instance.color = scene.materials[scene.nodes[node].material].color;
+        instance.model = scene.world(scene.nodes[node]);
+        // once per instance here instead of once per vertex in the shader
+        instance.normal = glm::transpose(glm::inverse(glm::mat3(instance.model)));
+        memcpy(instance.lights, lights.listOf(node), sizeof(instance.lights));
+        return instance;
+    }
+
+private:
+    CachedUniform instancedFlag{ "instanced" };
+    unsigned int builtVersion = ~0u;
+    unsigned int builtLights = ~0u;
+    std::vector<int> builtBatch;    // bucket of every node at the last upload, -1 if not drawn
+
+    // the queue has the same batches as the buckets and every queued node sits in
+    // the bucket it was uploaded to; a node is queued once, so equal counts then
+    // mean equal sets
+    bool sameBatches(const RenderQueue& queue) const
+    {
+        if (queue.batches.size() != buckets.size())
+            return false;
+        for (size_t b = 0; b < buckets.size(); b++)
+        {
+            const RenderQueue::Batch& batch = queue.batches[b];
+            if (batch.mesh != buckets[b].mesh || batch.count != buckets[b].count)
+                return false;
+            for (int i = batch.first; i < batch.first + batch.count; i++)
+            {
+                int node = queue.nodes[i];
+                if (node >= (int)builtBatch.size() || builtBatch[node] != (int)b)
+                    return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
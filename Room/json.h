@@ -0,0 +1,251 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Small JSON reader for the hand-edited scene files. Besides plain JSON it accepts
+// // line comments, so designers can label what they place. Every value keeps the
+// line it started on for error messages.
+struct JsonValue
+{
+    enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    Type type = NUL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;                               // ARRAY
+    std::vector<std::pair<std::string, JsonValue> > members;    // OBJECT, in file order
+    int line = 0;
+
+    // member of an object, nullptr if absent
+    const JsonValue* find(const std::string& key) const
+    {
+        for (const auto& member : members)
+            if (member.first == key)
+                return &member.second;
+        return nullptr;
+    }
+};
+
+class JsonParser
+{
+public:
+    std::string error;      // "line N: message" after a failed parse
+
+    bool parse(const std::string& text, JsonValue& root)
+    {
+        p = text.data();
+        end = p + text.size();
+        line = 1;
+        error.clear();
+        if (!parseValue(root, 0))
+            return false;
+        skipSpace();
+        if (p != end)
+            return fail("unexpected text after the document");
+        return true;
+    }
+
+private:
+    const char* end = nullptr;
+    const char* p = nullptr;
+    int line = 1;
+
+    static const int MAX_DEPTH = 64;
+
+    bool fail(const std::string& message)
+    {
+        if (error.empty())
+            error = "line " + std::to_string(line) + ": " + message;
+        return false;
+    }
+
+    void skipSpace()
+    {
+        while (p < end)
+        {
+            if (*p == '\n')
+            {
+                line++;
+                p++;
+            }
+            else if (*p == ' ' || *p == '\t' || *p == '\r')
+                p++;
+            else if (*p == '/' && p + 1 < end && p[1] == '/')
+            {
+                while (p < end && *p != '\n')
+                    p++;
+            }
+            else
+                break;
+        }
+    }
+
+    bool literal(const char* word)
+    {
+        const char* q = p;
+        for (; *word; word++, q++)
+            if (q >= end || *q != *word)
+                return false;
+        p = q;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth)
+    {
+        if (depth > MAX_DEPTH)
+            return fail("nested too deeply");
+        skipSpace();
+        value.line = line;
+        if (p >= end)
+            return fail("unexpected end of file");
+        char c = *p;
+        if (c == '{')
+            return parseObject(value, depth);
+        if (c == '[')
+            return parseArray(value, depth);
+        if (c == '"')
+        {
+            value.type = JsonValue::STRING;
+            return parseString(value.string);
+        }
+        if (c == '-' || (c >= '0' && c <= '9'))
+            return parseNumber(value);
+        if (literal("true"))
+        {
+            value.type = JsonValue::BOOLEAN;
+            value.boolean = true;
+            return true;
+        }
+        if (literal("false"))
+        {
+            value.type = JsonValue::BOOLEAN;
+            return true;
+        }
+        if (literal("null"))
+            return true;
+        return fail(std::string("unexpected character '") + c + "'");
+    }
+
+    bool parseObject(JsonValue& value, int depth)
+    {
+        value.type = JsonValue::OBJECT;
+        p++;
+        skipSpace();
+        if (p < end && *p == '}')
+        {
+            p++;
+            return true;
+        }
+        while (true)
+        {
+            skipSpace();
+            if (p >= end || *p != '"')
+                return fail("expected a member name");
+            std::string key;
+            if (!parseString(key))
+                return false;
+            skipSpace();
+            if (p >= end || *p != ':')
+                return fail("expected ':' after \"" + key + "\"");
+            p++;
+            value.members.push_back(std::make_pair(key, JsonValue()));
+            if (!parseValue(value.members.back().second, depth + 1))
+                return false;
+            skipSpace();
+            if (p < end && *p == ',')
+            {
+                p++;
+                continue;
+            }
+            if (p < end && *p == '}')
+            {
+                p++;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool parseArray(JsonValue& value, int depth)
+    {
+        value.type = JsonValue::ARRAY;
+        p++;
+        skipSpace();
+        if (p < end && *p == ']')
+        {
+            p++;
+            return true;
+        }
+        while (true)
+        {
+            value.items.push_back(JsonValue());
+            if (!parseValue(value.items.back(), depth + 1))
+                return false;
+            skipSpace();
+            if (p < end && *p == ',')
+            {
+                p++;
+                continue;
+            }
+            if (p < end && *p == ']')
+            {
+                p++;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    // \n and \t are translated and \u is rejected; any other escaped character is
+    // taken as it is, scene names are plain ASCII
+    bool parseString(std::string& out)
+    {
+        p++;
+        while (p < end && *p != '"')
+        {
+            if (*p == '\n')
+                return fail("line break inside a string");
+            if (*p == '\\' && p + 1 < end)
+            {
+                p++;
+                switch (*p)
+                {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'u': return fail("\\u escapes are not supported");
+                default: out += *p; break;
+                }
+                p++;
+            }
+            else
+                out += *p++;
+        }
+        if (p >= end)
+            return fail("unterminated string");
+        p++;
+        return true;
+    }
+
+    bool parseNumber(JsonValue& value)
+    {
+        // strtod would run past the buffer end on a number at the very end of the
+        // text, so copy the number's characters first
+        const char* start = p;
+        while (p < end && (*p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E' || (*p >= '0' && *p <= '9')))
+            p++;
+        std::string digits(start, p);
+        char* stop = nullptr;
+        value.type = JsonValue::NUMBER;
+        value.number = strtod(digits.c_str(), &stop);
+        if (stop != digits.c_str() + digits.size())
+            return fail("malformed number " + digits);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,537 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include "shader.h"
+#include "scene_graph.h"
+#include "light_uniforms.h"
+#include "render_stats.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// texture unit the cluster buffer is bound to; nothing else in the room samples
+const int CLUSTER_TEXTURE_UNIT = 0;
+
+// Clustered forward light culling. The view frustum is cut into TILES_X x TILES_Y
+// screen tiles and SLICES depth slices, spaced exponentially from SLICE_START to
+// far so clusters stay roughly cubic. Every frame the point and spot lights are
+// binned into the clusters they touch: the bounding sphere must cross the tile's
+// side planes, the slice's depth range and the cluster's box, and a spot's cone
+// must reach the cluster's bounding sphere. The fragment shader shades with the lights
+// of its own cluster only (the CLUSTERED program variant).
+//
+// The result is one GL_R32UI texture buffer:
+//
+//   [0, CLUSTERS)      header per cluster: first index << COUNT_BITS | light count
+//   CLUSTERS           header of the lights every fragment gets (directional)
+//   after that         light indices into LightData, cluster by cluster
+//
+// Binning splits the depth slices between the calling thread and a small pool of
+// workers; each owns whole clusters, so they never write the same memory and
+// their lists are concatenated in cluster order afterwards.
+class LightClusters
+{
+public:
+    static const int TILES_X = 16;
+    static const int TILES_Y = 9;
+    static const int SLICES = 32;
+    static const int CLUSTERS = TILES_X * TILES_Y * SLICES;
+    // the exponential slicing starts here instead of at the near plane, which would
+    // spend a third of the slices on the first metre; slice 0 reaches back to near
+    static constexpr float SLICE_START = 1.0f;
+    // a header's count holds 0 to MAX_LIGHTS, its first index the rest of the bits
+    static const int COUNT_BITS = 9;
+
+    static_assert(LightData::MAX_LIGHTS < (1 << COUNT_BITS), "a cluster header must hold every light");
+    static_assert((CLUSTERS + 1) * (LightData::MAX_LIGHTS + 1) < (1 << (32 - COUNT_BITS)), "a cluster header must address every list");
+
+    unsigned int buffer = 0, texture = 0;
+    std::vector<GLuint> data;           // the buffer contents of the last update
+    int threads = 1;                    // binning threads, the caller included
+
+    // of the last update
+    int lightCount = 0;                 // point and spot lights binned
+    float averageLights = 0.0f;         // per cluster with any light
+    int maxLights = 0;                  // in one cluster
+    double binMilliseconds = 0.0;
+
+    // threadCount 0 picks one per core, up to four
+    // ------------------------------------------------------------------------
+    void init(int threadCount = 0)
+    {
+        glGenBuffers(1, &buffer);
+        glGenTextures(1, &texture);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, (CLUSTERS + 1) * sizeof(GLuint), NULL, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        startWorkers(threadCount);
+    }
+
+    // bin the scene's lights for this camera and upload the result with one buffer write
+    // ------------------------------------------------------------------------
+    void update(const SceneGraph& scene, const glm::mat4& view, float fovy, float aspect, float nearPlane, float farPlane)
+    {
+        bin(scene, view, fovy, aspect, nearPlane, farPlane);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        // orphan the previous frame's storage instead of waiting for it
+        glBufferData(GL_TEXTURE_BUFFER, data.size() * sizeof(GLuint), data.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        countStateChange(2);
+    }
+
+    // CPU half of update(): fills data without touching GL
+    // ------------------------------------------------------------------------
+    void bin(const SceneGraph& scene, const glm::mat4& view, float fovy, float aspect, float nearPlane, float farPlane)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (fovy != builtFovy || aspect != builtAspect || nearPlane != builtNear || farPlane != builtFar)
+            buildClusterBoxes(fovy, aspect, nearPlane, farPlane);
+
+        // view-space bounding spheres of the point and spot lights, and the range of
+        // clusters each one can touch
+        int count = (int)scene.lights.size() < LightData::MAX_LIGHTS ? (int)scene.lights.size() : LightData::MAX_LIGHTS;
+        spheres.clear();
+        globalLights.clear();
+        for (int l = 0; l < count; l++)
+        {
+            const SceneLight& light = scene.lights[l];
+            if (light.type == LIGHT_DIRECTIONAL)
+            {
+                globalLights.push_back((GLuint)l);
+                continue;
+            }
+            Sphere sphere;
+            boundingSphere(light, sphere.center, sphere.radius);
+            sphere.center = glm::vec3(view * glm::vec4(sphere.center, 1.0f));
+            sphere.light = (GLuint)l;
+            sphere.spot = light.type == LIGHT_SPOT && light.outerCone < 90.0f;
+            if (sphere.spot)
+            {
+                const float toRadians = 3.14159265f / 180.0f;
+                sphere.position = glm::vec3(view * glm::vec4(light.position, 1.0f));
+                sphere.direction = glm::mat3(view) * light.direction;
+                sphere.range = light.range;
+                sphere.cosOuter = std::cos(light.outerCone * toRadians);
+                sphere.sinOuter = std::sin(light.outerCone * toRadians);
+            }
+            if (clusterRange(sphere))
+                spheres.push_back(sphere);
+        }
+
+        // each thread takes a run of whole depth slices
+        counts.resize(CLUSTERS);
+        lists.resize(threads);
+        offsets.resize(threads);
+        if (threads > 1)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending = threads - 1;
+                generation++;
+            }
+            wake.notify_all();
+            binShare(0);
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&]() { return pending == 0; });
+        }
+        else
+            binShare(0);
+
+        // headers of every share point past the lists of the shares before it
+        data.resize(CLUSTERS + 1);
+        GLuint first = CLUSTERS + 1;
+        data[CLUSTERS] = (first << COUNT_BITS) | (GLuint)globalLights.size();
+        data.insert(data.end(), globalLights.begin(), globalLights.end());
+        first += (GLuint)globalLights.size();
+        int used = 0;
+        long long total = 0;
+        maxLights = 0;
+        for (int t = 0; t < threads; t++)
+        {
+            int begin, end;
+            shareSlices(t, begin, end);
+            for (int c = begin * TILES_X * TILES_Y; c < end * TILES_X * TILES_Y; c++)
+            {
+                data[c] = ((first + offsets[t][c - begin * TILES_X * TILES_Y]) << COUNT_BITS) | counts[c];
+                used += counts[c] ? 1 : 0;
+                total += counts[c];
+                maxLights = std::max(maxLights, (int)counts[c]);
+            }
+            first += (GLuint)lists[t].size();
+            data.insert(data.end(), lists[t].begin(), lists[t].end());
+        }
+        lightCount = (int)spheres.size();
+        averageLights = used ? (float)total / used : 0.0f;
+        binMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the buffer on its texture unit and the cluster grid of the viewport, for a
+    // program built with the CLUSTERED variant
+    // ------------------------------------------------------------------------
+    void bind(const Shader& shader, int viewportWidth, int viewportHeight) const
+    {
+        glActiveTexture(GL_TEXTURE0 + CLUSTER_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        shader.setInt(lightsUniform.get(shader), CLUSTER_TEXTURE_UNIT);
+        shader.setVec3(gridUniform.get(shader), glm::vec3((float)TILES_X, (float)TILES_Y, (float)SLICES));
+        // slice = log(depth) * scale - log(sliceStart) * scale
+        float scale = SLICES / std::log(builtFar / sliceStart);
+        shader.setVec4(scaleUniform.get(shader), glm::vec4((float)TILES_X / viewportWidth, (float)TILES_Y / viewportHeight,
+            scale, std::log(sliceStart) * scale));
+        countStateChange(2);
+    }
+
+    // lights the fragment shader loops over at a viewport position (0 to 1 across
+    // and up) and view depth, the directional ones included; for statistics
+    // ------------------------------------------------------------------------
+    int lightsAt(float x, float y, float depth) const
+    {
+        const GLuint countMask = (1u << COUNT_BITS) - 1u;
+        int tileX = std::min(TILES_X - 1, std::max(0, (int)(x * TILES_X)));
+        int tileY = std::min(TILES_Y - 1, std::max(0, (int)(y * TILES_Y)));
+        int c = (sliceOf(depth) * TILES_Y + tileY) * TILES_X + tileX;
+        return (int)((data[c] & countMask) + (data[CLUSTERS] & countMask));
+    }
+
+    // lightsAt() averaged over the covered pixels of the bound framebuffer, from
+    // its depth buffer; waits for the frame to be drawn
+    // ------------------------------------------------------------------------
+    float lightsPerFragment(int width, int height) const
+    {
+        std::vector<float> depths((size_t)width * height);
+        glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, depths.data());
+        long long lights = 0;
+        int fragments = 0;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                float z = depths[(size_t)y * width + x];
+                if (z >= 1.0f)
+                    continue;
+                // window depth back to view depth through the perspective projection
+                float ndc = 2.0f * z - 1.0f;
+                float depth = 2.0f * builtNear * builtFar / (builtFar + builtNear - ndc * (builtFar - builtNear));
+                lights += lightsAt((x + 0.5f) / width, (y + 0.5f) / height, depth);
+                fragments++;
+            }
+        }
+        return fragments ? (float)lights / fragments : 0.0f;
+    }
+
+    void release()
+    {
+        stopWorkers();
+        glDeleteTextures(1, &texture);
+        glDeleteBuffers(1, &buffer);
+    }
+
+    ~LightClusters()
+    {
+        stopWorkers();
+    }
+
+private:
+    struct Sphere
+    {
+        glm::vec3 center;
+        float radius;
+        GLuint light;
+        int tiles[4];       // first x, last x, first y, last y
+        int slices[2];      // first, last
+        // the cone of a spot light, in view space
+        bool spot;
+        glm::vec3 position, direction;
+        float range, cosOuter, sinOuter;
+    };
+
+    CachedUniform lightsUniform{ "clusterLights" }, gridUniform{ "clusterGrid" }, scaleUniform{ "clusterScale" };
+
+    float builtFovy = 0.0f, builtAspect = 0.0f, builtNear = 0.0f, builtFar = 0.0f;
+    float sliceStart = 0.0f;
+    float tanX = 0.0f, tanY = 0.0f;
+    std::vector<glm::vec3> boxMin, boxMax;          // view-space box of every cluster
+    std::vector<glm::vec4> bounds;                  // view-space bounding sphere of every cluster, w: radius
+    std::vector<Sphere> spheres;
+    std::vector<GLuint> globalLights;
+    std::vector<uint16_t> counts;                   // lights per cluster
+    std::vector<std::vector<GLuint>> lists;         // light indices of every share
+    std::vector<std::vector<GLuint>> offsets;       // of each of the share's clusters in its list
+    std::vector<std::vector<unsigned char>> scratch;   // light indices, MAX_LIGHTS slots per cluster
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    unsigned int generation = 0;
+    int pending = 0;
+    bool stopping = false;
+
+    // ------------------------------------------------------------------------
+    void buildClusterBoxes(float fovy, float aspect, float nearPlane, float farPlane)
+    {
+        builtFovy = fovy;
+        builtAspect = aspect;
+        builtNear = nearPlane;
+        sliceStart = std::max(nearPlane, (float)SLICE_START);
+        builtFar = farPlane;
+        tanY = std::tan(fovy * 0.5f);
+        tanX = tanY * aspect;
+        boxMin.resize(CLUSTERS);
+        boxMax.resize(CLUSTERS);
+        bounds.resize(CLUSTERS);
+        for (int z = 0; z < SLICES; z++)
+        {
+            float nearDepth = sliceDepth(z), farDepth = sliceDepth(z + 1);
+            for (int y = 0; y < TILES_Y; y++)
+            {
+                float y0 = (2.0f * y / TILES_Y - 1.0f) * tanY, y1 = (2.0f * (y + 1) / TILES_Y - 1.0f) * tanY;
+                for (int x = 0; x < TILES_X; x++)
+                {
+                    float x0 = (2.0f * x / TILES_X - 1.0f) * tanX, x1 = (2.0f * (x + 1) / TILES_X - 1.0f) * tanX;
+                    // the tile's edges at both ends of the slice bound it
+                    int c = (z * TILES_Y + y) * TILES_X + x;
+                    boxMin[c] = glm::vec3(std::min(x0 * nearDepth, x0 * farDepth), std::min(y0 * nearDepth, y0 * farDepth), -farDepth);
+                    boxMax[c] = glm::vec3(std::max(x1 * nearDepth, x1 * farDepth), std::max(y1 * nearDepth, y1 * farDepth), -nearDepth);
+                    // around the eight corners of the frustum piece, for the cone test
+                    glm::vec3 corners[8];
+                    glm::vec3 center(0.0f);
+                    for (int k = 0; k < 8; k++)
+                    {
+                        float depth = k & 4 ? farDepth : nearDepth;
+                        corners[k] = glm::vec3((k & 1 ? x1 : x0) * depth, (k & 2 ? y1 : y0) * depth, -depth);
+                        center += corners[k] * 0.125f;
+                    }
+                    float radius = 0.0f;
+                    for (int k = 0; k < 8; k++)
+                        radius = std::max(radius, glm::length(corners[k] - center));
+                    bounds[c] = glm::vec4(center, radius);
+                }
+            }
+        }
+    }
+
+    float sliceDepth(int slice) const
+    {
+        if (slice == 0)
+            return builtNear;
+        return sliceStart * std::pow(builtFar / sliceStart, (float)slice / SLICES);
+    }
+
+    int sliceOf(float depth) const
+    {
+        int slice = (int)std::floor(std::log(depth / sliceStart) / std::log(builtFar / sliceStart) * SLICES);
+        return std::min(SLICES - 1, std::max(0, slice));
+    }
+
+    // the smallest sphere around a spot light's cone, or its range
+    static void boundingSphere(const SceneLight& light, glm::vec3& center, float& radius)
+    {
+        const float toRadians = 3.14159265f / 180.0f;
+        float angle = light.outerCone * toRadians;
+        if (light.type != LIGHT_SPOT || angle >= 1.5707963f)
+        {
+            center = light.position;
+            radius = light.range;
+        }
+        else if (angle > 0.7853982f)
+        {
+            center = light.position + light.direction * (light.range * std::cos(angle));
+            radius = light.range * std::sin(angle);
+        }
+        else
+        {
+            float half = light.range / (2.0f * std::cos(angle));
+            center = light.position + light.direction * half;
+            radius = half;
+        }
+    }
+
+    // tile and slice ranges the sphere reaches; false when it is outside the depth
+    // range or the frustum's sides
+    bool clusterRange(Sphere& sphere) const
+    {
+        float nearDepth = std::max(builtNear, -sphere.center.z - sphere.radius);
+        float farDepth = std::min(builtFar, -sphere.center.z + sphere.radius);
+        if (nearDepth > farDepth)
+            return false;
+        sphere.slices[0] = sliceOf(nearDepth);
+        sphere.slices[1] = sliceOf(farDepth);
+        return tileRange(sphere.center.x, sphere.center.z, sphere.radius, tanX, TILES_X, sphere.tiles[0], sphere.tiles[1])
+            && tileRange(sphere.center.y, sphere.center.z, sphere.radius, tanY, TILES_Y, sphere.tiles[2], sphere.tiles[3]);
+    }
+
+    // the tiles along one screen axis whose side planes through the eye the sphere
+    // crosses; coordinate is the centre's view-space x or y
+    static bool tileRange(float coordinate, float z, float radius, float tangent, int tiles, int& first, int& last)
+    {
+        // signed distance to the plane of tile edge e, positive on the side of the higher tiles
+        auto distance = [&](int edge) {
+            float slope = (2.0f * edge / tiles - 1.0f) * tangent;
+            return (coordinate + slope * z) / std::sqrt(1.0f + slope * slope);
+        };
+        first = 0;
+        while (first < tiles && distance(first + 1) > radius)
+            first++;
+        last = tiles - 1;
+        while (last >= 0 && distance(last) < -radius)
+            last--;
+        return first <= last;
+    }
+
+    void shareSlices(int share, int& begin, int& end) const
+    {
+        begin = SLICES * share / threads;
+        end = SLICES * (share + 1) / threads;
+    }
+
+    // bin every sphere into the clusters of the share's slices, then pack the
+    // per-cluster lists into the share's list
+    void binShare(int share)
+    {
+        int begin, end;
+        shareSlices(share, begin, end);
+        const int perSlice = TILES_X * TILES_Y;
+        std::vector<unsigned char>& bins = scratch[share];
+        bins.resize((size_t)(end - begin) * perSlice * LightData::MAX_LIGHTS);
+        uint16_t* clusterCounts = &counts[begin * perSlice];
+        memset(clusterCounts, 0, (size_t)(end - begin) * perSlice * sizeof(uint16_t));
+
+        for (const Sphere& sphere : spheres)
+        {
+            int z0 = std::max(begin, sphere.slices[0]), z1 = std::min(end - 1, sphere.slices[1]);
+            float radius2 = sphere.radius * sphere.radius;
+            for (int z = z0; z <= z1; z++)
+            {
+                for (int y = sphere.tiles[2]; y <= sphere.tiles[3]; y++)
+                {
+                    for (int x = sphere.tiles[0]; x <= sphere.tiles[1]; x++)
+                    {
+                        int c = (z * TILES_Y + y) * TILES_X + x;
+                        // squared distance from the centre to the cluster's box
+                        float dx = std::max(0.0f, std::max(boxMin[c].x - sphere.center.x, sphere.center.x - boxMax[c].x));
+                        float dy = std::max(0.0f, std::max(boxMin[c].y - sphere.center.y, sphere.center.y - boxMax[c].y));
+                        float dz = std::max(0.0f, std::max(boxMin[c].z - sphere.center.z, sphere.center.z - boxMax[c].z));
+                        if (dx * dx + dy * dy + dz * dz > radius2)
+                            continue;
+                        if (sphere.spot && !coneReaches(sphere, bounds[c]))
+                            continue;
+                        int local = c - begin * perSlice;
+                        bins[(size_t)local * LightData::MAX_LIGHTS + clusterCounts[local]++] = (unsigned char)sphere.light;
+                    }
+                }
+            }
+        }
+
+        std::vector<GLuint>& list = lists[share];
+        std::vector<GLuint>& offset = offsets[share];
+        list.clear();
+        offset.resize((size_t)(end - begin) * perSlice);
+        for (int local = 0; local < (end - begin) * perSlice; local++)
+        {
+            offset[local] = (GLuint)list.size();
+            const unsigned char* bin = &bins[(size_t)local * LightData::MAX_LIGHTS];
+            list.insert(list.end(), bin, bin + clusterCounts[local]);
+        }
+    }
+
+    // whether a spot's cone reaches a cluster's bounding sphere: the sphere is in
+    // front of the apex, before the range, and no further from the cone's surface
+    // than its radius
+    static bool coneReaches(const Sphere& spot, const glm::vec4& bound)
+    {
+        glm::vec3 toCenter = glm::vec3(bound) - spot.position;
+        float along = glm::dot(toCenter, spot.direction);
+        if (along < -bound.w || along > spot.range + bound.w)
+            return false;
+        float across = std::sqrt(std::max(0.0f, glm::dot(toCenter, toCenter) - along * along));
+        return spot.cosOuter * across - spot.sinOuter * along <= bound.w;
+    }
+
+    void startWorkers(int threadCount)
+    {
+        if (threadCount <= 0)
+            threadCount = std::min(4, (int)std::max(1u, std::thread::hardware_concurrency()));
+        threads = std::min(threadCount, (int)SLICES);
+        scratch.resize(threads);
+        for (int t = 1; t < threads; t++)
+        {
+            workers.emplace_back([this, t]() {
+                unsigned int seen = 0;
+                for (;;)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        wake.wait(lock, [&]() { return stopping || generation != seen; });
+                        if (stopping)
+                            return;
+                        seen = generation;
+                    }
+                    binShare(t);
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        pending--;
+                    }
+                    done.notify_one();
+                }
+            });
+        }
+    }
+
+    void stopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+        workers.clear();
+    }
+};
+
+// count lamps spread over the scene's rooms, in a fixed pseudo-random layout:
+// warm point lights with a short range below the ceiling, every fourth a spot
+// shining down. Used to measure how shading scales with the number of lights;
+// rangeScale shrinks the ranges so more lamps can keep the same overlap.
+// ------------------------------------------------------------------------
+inline void scatterLights(SceneGraph& scene, int count, float rangeScale = 1.0f)
+{
+    unsigned int state = 12345u;
+    auto random = [&]() {
+        state = state * 1664525u + 1013904223u;
+        return (float)(state >> 8) / 16777216.0f;
+    };
+    for (int l = 0; l < count; l++)
+    {
+        glm::vec3 low(0.0f), high(10.0f, 5.0f, 10.0f);
+        if (!scene.rooms.empty())
+        {
+            const SceneRoom& room = scene.rooms[l % scene.rooms.size()];
+            low = room.boundsMin;
+            high = room.boundsMax;
+        }
+        glm::vec3 position(low.x + (high.x - low.x) * random(), low.y + 1.0f + (high.y - low.y - 1.3f) * random(),
+            low.z + (high.z - low.z) * random());
+        glm::vec3 color = glm::vec3(1.0f, 0.8f, 0.55f) * (0.8f + 0.8f * random());
+        float range = (2.0f + 2.0f * random()) * rangeScale;
+        if (l % 4 == 3)
+            scene.addLight(LIGHT_SPOT, position, glm::vec3(0.0f, -1.0f, 0.0f), color * 2.0f, range + rangeScale, 20.0f, 35.0f);
+        else
+            scene.addLight(LIGHT_POINT, position, glm::vec3(0.0f), color, range);
+    }
+}
+
+#endif
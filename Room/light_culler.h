@@ -0,0 +1,119 @@
+#ifndef LIGHT_CULLER_H
+#define LIGHT_CULLER_H
+
+#include "scene_graph.h"
+#include "frustum_culler.h"
+#include "light_uniforms.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Per-object light lists. Every scene node gets the lights whose range reaches
+// the bounding sphere of its world box, a spot light only if the sphere also
+// overlaps its cone. A list is four GLuints of four byte slots each: the first
+// slot holds the number of lights and the next ones their indices, so the shader
+// loops exactly that many times and an all-zero list means unlit by anything but
+// the ambient term. A node reached by more than MAX_PER_OBJECT lights keeps the
+// strongest. Lists are rebuilt when the culler's boxes change.
+class LightCuller
+{
+public:
+    static const int MAX_PER_OBJECT = 15;
+
+    std::vector<GLuint> lists;      // four per scene node
+    unsigned int version = 0;       // bumped whenever the lists are rebuilt
+    float averageLights = 0.0f;     // per node, of the last rebuild
+
+    // ------------------------------------------------------------------------
+    void update(const SceneGraph& scene, const FrustumCuller& culler)
+    {
+        if (culler.boxesVersion() == builtVersion)
+            return;
+        builtVersion = culler.boxesVersion();
+        version++;
+
+        int count = (int)scene.nodes.size();
+        lists.assign((size_t)count * 4, 0);
+        long long total = 0;
+        for (int n = 0; n < count; n++)
+        {
+            glm::vec3 center, extent;
+            culler.nodeBox(n, center, extent);
+            total += listFor(scene, center, glm::length(extent), &lists[(size_t)n * 4]);
+        }
+        averageLights = count ? (float)total / count : 0.0f;
+    }
+
+    const GLuint* listOf(int node) const
+    {
+        return &lists[(size_t)node * 4];
+    }
+
+    // the list of a sphere that is not a scene node, e.g. a fan blade; returns the
+    // number of lights in it
+    // ------------------------------------------------------------------------
+    int listFor(const SceneGraph& scene, const glm::vec3& center, float radius, GLuint out[4])
+    {
+        candidates.clear();
+        int count = (int)scene.lights.size() < LightData::MAX_LIGHTS ? (int)scene.lights.size() : LightData::MAX_LIGHTS;
+        for (int l = 0; l < count; l++)
+        {
+            float strength = reach(scene.lights[l], center, radius);
+            if (strength > 0.0f)
+                candidates.push_back({ strength, l });
+        }
+        if ((int)candidates.size() > MAX_PER_OBJECT)
+        {
+            std::partial_sort(candidates.begin(), candidates.begin() + MAX_PER_OBJECT, candidates.end(),
+                [](const Candidate& a, const Candidate& b) { return a.strength > b.strength; });
+            candidates.resize(MAX_PER_OBJECT);
+            // keep the lights in index order so equal sets give equal lists
+            std::sort(candidates.begin(), candidates.end(),
+                [](const Candidate& a, const Candidate& b) { return a.light < b.light; });
+        }
+        out[0] = (GLuint)candidates.size();
+        out[1] = out[2] = out[3] = 0;
+        for (size_t i = 0; i < candidates.size(); i++)
+            out[(i + 1) >> 2] |= (GLuint)candidates[i].light << (8 * ((i + 1) & 3));
+        return (int)candidates.size();
+    }
+
+private:
+    struct Candidate
+    {
+        float strength;
+        int light;
+    };
+
+    unsigned int builtVersion = ~0u;
+    std::vector<Candidate> candidates;
+
+    // how strongly the light can reach the sphere, 0 when it cannot at all
+    static float reach(const SceneLight& light, const glm::vec3& center, float radius)
+    {
+        float brightness = std::max(light.color.x, std::max(light.color.y, light.color.z));
+        if (light.type == LIGHT_DIRECTIONAL)
+            return brightness;
+
+        glm::vec3 toCenter = center - light.position;
+        float distance = glm::length(toCenter);
+        if (distance >= light.range + radius)
+            return 0.0f;
+        if (light.type == LIGHT_SPOT && distance > radius)
+        {
+            // the sphere subtends asin(radius / distance) around its centre's direction
+            const float toRadians = 3.14159265f / 180.0f;
+            float cosine = glm::dot(toCenter / distance, light.direction);
+            float angle = std::acos(std::min(1.0f, std::max(-1.0f, cosine)));
+            if (angle - std::asin(radius / distance) > light.outerCone * toRadians)
+                return 0.0f;
+        }
+        float nearest = std::max(0.0f, distance - radius);
+        return brightness / (1.0f + nearest * nearest);
+    }
+};
+
+#endif
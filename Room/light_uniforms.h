@@ -0,0 +1,101 @@
+#ifndef LIGHT_UNIFORMS_H
+#define LIGHT_UNIFORMS_H
+
+#include "shader.h"
+#include "scene_graph.h"
+#include "render_stats.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+// std140 layout of one Light of the LightData block in fragmentShader.fs. Three
+// vec4s instead of four keep 256 lights under the 16 KB uniform block minimum:
+// the type is folded into the range (negative for directional lights) and point
+// lights get a cone no direction falls outside of.
+struct LightEntry
+{
+    glm::vec4 position;     // w: range, negative for a directional light
+    glm::vec4 direction;    // w: cosine of the outer cone
+    glm::vec4 color;        // w: cosine of the inner cone
+};
+
+// std140 layout of the LightData block; specular holds the strength and shininess
+struct LightData
+{
+    // light indices are stored in bytes, see LightCuller and LightClusters
+    static const int MAX_LIGHTS = 256;
+
+    glm::vec4 ambient;
+    glm::vec4 specular;
+    LightEntry lights[MAX_LIGHTS];
+};
+static_assert(sizeof(LightData) == 32 + 48 * LightData::MAX_LIGHTS, "LightData must match the std140 block");
+
+// Every light of the scene in one uniform buffer at LIGHT_DATA_BINDING. The
+// fragment shader never walks the whole array: each draw carries the list of
+// the lights that reach it (LightCuller) and only those are read. The block is
+// rewritten when the scene version changes.
+class LightUniforms
+{
+public:
+    unsigned int ubo = 0;
+    LightData data;
+    glm::vec3 ambient = glm::vec3(0.45f);
+    float specularStrength = 0.3f;
+    float shininess = 32.0f;
+    int count = 0;                  // lights in the block
+
+    void init()
+    {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightData), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_DATA_BINDING, ubo);
+    }
+
+    // lights past MAX_LIGHTS are dropped, the culler never lists them
+    // ------------------------------------------------------------------------
+    void update(const SceneGraph& scene)
+    {
+        if (scene.version == builtVersion)
+            return;
+        builtVersion = scene.version;
+
+        data.ambient = glm::vec4(ambient, 1.0f);
+        data.specular = glm::vec4(specularStrength, shininess, 0.0f, 0.0f);
+        count = (int)scene.lights.size() < LightData::MAX_LIGHTS ? (int)scene.lights.size() : LightData::MAX_LIGHTS;
+        for (int l = 0; l < count; l++)
+        {
+            const SceneLight& light = scene.lights[l];
+            const float toRadians = 3.14159265f / 180.0f;
+            LightEntry& entry = data.lights[l];
+            entry.position = glm::vec4(light.position, light.type == LIGHT_DIRECTIONAL ? -1.0f : light.range);
+            if (light.type == LIGHT_SPOT)
+            {
+                entry.direction = glm::vec4(light.direction, std::cos(light.outerCone * toRadians));
+                entry.color = glm::vec4(light.color, std::cos(light.innerCone * toRadians));
+            }
+            else
+            {
+                // the spot factor is 1 for every direction
+                entry.direction = glm::vec4(light.direction, -2.0f);
+                entry.color = glm::vec4(light.color, -1.0f);
+            }
+        }
+        // only the used part of the array is uploaded
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, 32 + count * sizeof(LightEntry), &data);
+        countStateChange(2);
+    }
+
+    void release()
+    {
+        glDeleteBuffers(1, &ubo);
+    }
+
+private:
+    unsigned int builtVersion = ~0u;
+};
+
+#endif
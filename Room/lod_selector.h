@@ -0,0 +1,87 @@
+#ifndef LOD_SELECTOR_H
+#define LOD_SELECTOR_H
+
+#include "scene_graph.h"
+#include "frustum_culler.h"
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Picks the level of detail of every visible node from the projected size of its
+// world bounding sphere: the sphere's diameter over the screen height. A mesh's
+// lodNext chain lists its coarser versions, each switched to below the previous
+// level's lodBelow. Going coarser needs the size to drop HYSTERESIS under the
+// threshold and going finer to rise the same amount over it, so a camera resting
+// near a threshold does not flip levels every frame. Hidden nodes keep their
+// level until they are seen again.
+class LodSelector
+{
+public:
+    static constexpr float HYSTERESIS = 0.15f;
+
+    std::vector<int> meshes;        // mesh to draw for every scene node
+    unsigned int version = 0;       // bumped whenever an entry of meshes changes
+    bool enabled = true;            // off always draws the node's own mesh
+
+    // ------------------------------------------------------------------------
+    void select(const SceneGraph& scene, const FrustumCuller& culler, const glm::vec3& eye, const glm::mat4& projection)
+    {
+        int count = (int)scene.nodes.size();
+        if (scene.version != builtVersion || (int)meshes.size() != count)
+        {
+            builtVersion = scene.version;
+            meshes.resize(count);
+            for (int n = 0; n < count; n++)
+                meshes[n] = scene.nodes[n].mesh;
+            version++;
+        }
+        if (!enabled)
+            return;
+
+        // projection[1][1] is 1 / tan(fovy / 2)
+        float focal = projection[1][1];
+        bool changed = false;
+        for (int n = 0; n < count; n++)
+        {
+            if (!culler.visible[n] || scene.meshes[scene.nodes[n].mesh].lodNext < 0)
+                continue;
+            glm::vec3 center, extent;
+            culler.nodeBox(n, center, extent);
+            float distance = glm::length(center - eye);
+            float size = distance > 0.0f ? glm::length(extent) * focal / distance : 1e30f;
+
+            int mesh = meshes[n];
+            // coarser while below the current level's threshold
+            while (scene.meshes[mesh].lodNext >= 0 && size < scene.meshes[mesh].lodBelow * (1.0f - HYSTERESIS))
+                mesh = scene.meshes[mesh].lodNext;
+            // finer while above the threshold that led to the current level
+            int finer = finerMesh(scene, scene.nodes[n].mesh, mesh);
+            while (finer >= 0 && size > scene.meshes[finer].lodBelow * (1.0f + HYSTERESIS))
+            {
+                mesh = finer;
+                finer = finerMesh(scene, scene.nodes[n].mesh, mesh);
+            }
+            if (mesh != meshes[n])
+            {
+                meshes[n] = mesh;
+                changed = true;
+            }
+        }
+        if (changed)
+            version++;
+    }
+
+private:
+    unsigned int builtVersion = ~0u;
+
+    // the level before mesh in the chain starting at base, -1 at the base itself
+    static int finerMesh(const SceneGraph& scene, int base, int mesh)
+    {
+        for (int level = base; level >= 0 && level != mesh; level = scene.meshes[level].lodNext)
+            if (scene.meshes[level].lodNext == mesh)
+                return level;
+        return -1;
+    }
+};
+
+#endif
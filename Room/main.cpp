@@ -10,7 +10,35 @@
 #include "basic_camera.h"
 #include "fan.h"
 #include "cylinders.h"
+#include "scene_graph.h"
+#include "microbench.h"
+#include "mesh_arena.h"
+#include "instanced_renderer.h"
+#include "headless.h"
+#include "frame_writer.h"
+#include "camera_path.h"
+#include "run_options.h"
+#include "frame_timer.h"
+#include "timing_overlay.h"
+#include "camera_recording.h"
+#include "render_stats.h"
+#include "frustum_culler.h"
+#include "portal_visibility.h"
+#include "render_queue.h"
+#include "lod_selector.h"
+#include "mesh_optimizer.h"
+#include "static_renderer.h"
+#include "frame_uniforms.h"
+#include "light_uniforms.h"
+#include "light_culler.h"
+#include "light_clusters.h"
+#include "scene_file.h"
+#include "scene_text.h"
+#include "file_watcher.h"
 #include <iostream>
+#include <cstring>
+#include <chrono>
+#include <future>
 
 using namespace std;
 
@@ -18,10 +46,16 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
+void moveCamera(Camera_Movement direction);
+void buildRoomMeshes(SceneGraph& scene, MeshArena& arena);
+void buildRoomScene(SceneGraph& scene, MeshArena& arena);
 
 // settings
 const unsigned int SCR_WIDTH = 1500;
 const unsigned int SCR_HEIGHT = 800;
+// depth range of the projection, also sliced by the light clusters
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
 
 // modelling transform
 float rotateAngle_X = 0.0;
@@ -38,6 +72,7 @@ float scale_Y = 1.0;
 float scale_Z = 1.0;
 bool fan_turn = false;
 bool rotate_around = false;
+bool show_timing = false;
 
 // camera
 Camera camera(glm::vec3(-3.0f, 2.5f, 4.3f));
@@ -51,63 +86,547 @@ float lookAtX = 0.0, lookAtY = 0.0, lookAtZ = 0.0;
 glm::vec3 V = glm::vec3(0.0f, 1.0f, 0.0f);
 BasicCamera basic_camera(eyeX, eyeY, eyeZ, lookAtX, lookAtY, lookAtZ, V);
 
+// framebuffer size, kept by framebuffer_size_callback
+int viewportWidth = SCR_WIDTH, viewportHeight = SCR_HEIGHT;
+
 // timing
 float deltaTime = 0.0f;  
 float lastFrame = 0.0f;
 
-glm::mat4 transforamtion(float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz) {
-    glm::mat4 identityMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-    glm::mat4 translateMatrix, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix, model;
-    translateMatrix = glm::translate(identityMatrix, glm::vec3(tx, ty, tz));
-    rotateXMatrix = glm::rotate(identityMatrix, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
-    rotateYMatrix = glm::rotate(identityMatrix, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-    rotateZMatrix = glm::rotate(identityMatrix, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
-    scaleMatrix = glm::scale(identityMatrix, glm::vec3(sx, sy, sz));
-    model = translateMatrix * rotateXMatrix * rotateYMatrix * rotateZMatrix * scaleMatrix;
-    return model;
-}
+// camera input of the current frame, appended to the recording with --record
+CameraInput frameInput;
+CameraRecording recordedInput;
 
-int main()
+int main(int argc, char** argv)
 {
-    // glfw: initialize and configure
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    RunOptions options;
+    if (!parseRunOptions(argc, argv, options))
+        return -1;
+
+    GLFWwindow* window = NULL;
+    HeadlessContext headless;
+    if (options.headless)
+    {
+        // offscreen context and framebuffer, no display needed
+        if (!headless.create(SCR_WIDTH, SCR_HEIGHT))
+        {
+            headless.release();
+            return -1;
+        }
+    }
+    else
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-    // glfw window creation
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LAB FINAL", NULL, NULL);
-    if (window == NULL)
+        // glfw window creation
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LAB FINAL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwGetFramebufferSize(window, &viewportWidth, &viewportHeight);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+
+        // tell GLFW to capture our mouse
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+    }
+
+    // configure global opengl state
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile our shader zprogram, or load it from the program binary cache;
+    // clustered lighting gets its own variant so neither program carries the other's
+    // light loop
+    Shader::useBinaryCache() = options.shaderCache;
+    auto shaderStart = std::chrono::steady_clock::now();
+    Shader ourShader("vertexShader.vs", "fragmentShader.fs", options.clusters ? "CLUSTERED" : "");
+    printf("shader program ready in %.2f ms\n", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStart).count());
+
+    show_timing = options.overlay;
+
+    // uniform setter, transform and mesh microbenchmarks, run instead of the render loop
+    if (options.benchUniforms || options.benchTransforms || options.benchMeshes || options.benchLights)
     {
-        std::cout << "Failed to create GLFW window" << std::endl;
+        if (options.benchUniforms)
+            benchUniformSetters(ourShader);
+        if (options.benchTransforms)
+            benchTransforms();
+        if (options.benchMeshes)
+        {
+            benchCylinders();
+            benchMeshOptimizer();
+        }
+        if (options.benchLights)
+            benchLightClusters();
+        headless.release();
         glfwTerminate();
-        return -1;
+        return 0;
+    }
+
+    // geometry and scene either come from a scene file or from the arrays compiled into buildRoomScene()
+    MeshArena arena;
+    arena.pack = options.pack;
+    SceneGraph scene;
+    if (!options.scene.empty())
+    {
+        // with --watch the CPU copies are kept, so a reload can upload just what changed
+        auto loadStart = std::chrono::steady_clock::now();
+        bool loaded = isTextScenePath(options.scene) ? loadSceneText(options.scene, scene, arena, buildRoomMeshes, !options.watch)
+            : loadSceneFile(options.scene, scene, arena, !options.watch);
+        if (!loaded)
+            return -1;
+        if (options.watch)
+            arena.upload();
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        reportSceneLoad(options.scene, scene, arena, loadMs);
+    }
+    else
+    {
+        buildRoomScene(scene, arena);
+        MeshOptimizationReport optimization = optimizeMeshes(scene, arena);
+        printMeshOptimization(optimization);
+        scene.computeMeshBounds(arena);
+        if (!options.exportScene.empty())
+        {
+            bool written = isTextScenePath(options.exportScene) ? writeSceneText(options.exportScene, scene)
+                : writeSceneFile(options.exportScene, scene, arena);
+            if (written)
+                std::cout << "Exported " << scene.nodes.size() << " nodes to " << options.exportScene << std::endl;
+            headless.release();
+            glfwTerminate();
+            return written ? 0 : -1;
+        }
+        arena.upload();
+        size_t rawBytes = optimization.verticesBefore * MeshArena::VERTEX_FLOATS * sizeof(float) + optimization.indicesBefore * sizeof(unsigned int);
+        printf("%.1f KB geometry in GL buffers (%s vertices, %d-bit indices), %.1f KB saved\n", arena.gpuBytes() / 1024.0,
+            arena.packedVertices ? "packed" : "float", (int)arena.indexSize() * 8, ((double)rawBytes - arena.gpuBytes()) / 1024.0);
     }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
 
-    // tell GLFW to capture our mouse
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    // extra lamps to measure how shading scales with the number of lights
+    if (options.lights > 0)
+        scatterLights(scene, options.lights);
+    if ((int)scene.lights.size() > LightData::MAX_LIGHTS)
+        std::cout << scene.lights.size() << " lights, only the first " << LightData::MAX_LIGHTS << " are used" << std::endl;
 
-    // glad: load all OpenGL function pointers
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    // the overlay draws the unit cube mesh directly
+    int cubeMesh = scene.findMesh("cube");
+    if (cubeMesh < 0)
     {
-        std::cout << "Failed to initialize GLAD" << std::endl;
+        std::cout << "Scene has no \"cube\" mesh" << std::endl;
         return -1;
     }
 
-    // configure global opengl state
-    glEnable(GL_DEPTH_TEST);
+    // the whole scene is drawn instanced, one draw call per arena mesh
+    InstancedRenderer instanced;
+    instanced.init(arena);
+
+    // bounding boxes of the scene nodes, tested against the view frustum every frame
+    FrustumCuller culler;
+
+    // rooms are cells and the door openings portals; a room is only drawn when the
+    // camera's room can see it through a chain of doors; the ceiling fan rigs are
+    // posed once and only re-rotated while they turn
+    PortalVisibility rooms;
+    std::vector<Fan> fans;
+    auto buildRoomsAndFans = [&]() {
+        rooms = PortalVisibility();
+        for (const SceneRoom& room : scene.rooms)
+            rooms.addCell(room.name, room.boundsMin, room.boundsMax);
+        for (const ScenePortal& portal : scene.portals)
+            rooms.addPortal(portal.rooms[0] + 1, portal.rooms[1] + 1, portal.boundsMin, portal.boundsMax);
+        fans.clear();
+        for (const SceneFan& rig : scene.fans)
+            fans.push_back(Fan(scene.transforms, rig.instance < 0 ? -1 : scene.instances[rig.instance].transform, rig.offset));
+    };
+    buildRoomsAndFans();
+
+    // the lights reaching every node, so each draw shades with its own short list
+    LightCuller lightCuller;
+
+    // level of detail of the round furniture, from its projected size
+    LodSelector lod;
+    lod.enabled = options.lod;
+
+    // visible nodes sorted by program, mesh, material and depth, merged into instanced batches
+    RenderQueue queue;
+
+    // with multi-draw indirect the static nodes are uploaded once and each frame only
+    // rewrites the draw commands of the visible ones; the queue is the fallback
+    StaticRenderer staticRenderer;
+    bool indirect = options.indirect && StaticRenderer::supported();
+    if (indirect)
+        staticRenderer.init(arena);
+    std::cout << "static geometry: " << (indirect ? "multi-draw indirect" : "instanced batches") << std::endl;
+
+    int i = 0;
+    // seconds of animation in the frame block: the GLFW clock in the window, derived
+    // from the frame number when replaying or rendering headless (no GLFW there)
+    float animationTime = 0.0f;
+    int exitCode = 0;
+
+    // per-phase CPU times and GPU time of every frame
+    FrameTimer timer;
+    timer.init();
+    TimingOverlay overlay;
+
+    // view, projection and camera position of the frame, one uniform block for every program
+    FrameUniforms frameUniforms;
+    frameUniforms.init();
+
+    // every light of the scene, uploaded when the scene changes
+    LightUniforms lightUniforms;
+    lightUniforms.init();
+
+    // the lights binned into view frustum clusters every frame; without it each
+    // object shades with its own list from the light culler
+    LightClusters lightClusters;
+    if (options.clusters)
+    {
+        lightClusters.init();
+        std::cout << "lighting: " << LightClusters::TILES_X << "x" << LightClusters::TILES_Y << "x" << LightClusters::SLICES
+            << " clusters, " << lightClusters.threads << (lightClusters.threads == 1 ? " binning thread" : " binning threads") << std::endl;
+    }
+    else
+        std::cout << "lighting: per-object light lists" << std::endl;
+
+    // the fan blades are drawn one at a time with these
+    CachedUniform fanModelUniform("model"), fanNormalUniform("normalMatrix"), fanColorUniform("objectColor"), fanLightsUniform("objectLights");
+
+    // draws one frame of the room into the bound framebuffer
+    auto renderScene = [&]() {
+        // ---projection, camera/view and model matrices--
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, NEAR_PLANE, FAR_PLANE);
+        glm::mat4 view = camera.GetViewMatrix();
+        for (Fan& fan : fans)
+            fan.update(scene.transforms, (float)i);
+        scene.update();
+
+        // ---visibility--
+        culler.update(scene);
+        lightCuller.update(scene, culler);
+        if (options.frustumCulling)
+            culler.cull(projection * view);
+        else
+            culler.showAll();
+        if (options.portalCulling)
+            rooms.cull(camera.Position, projection * view, culler);
+        lod.select(scene, culler, camera.Position, projection);
+
+        // ---sorted, batched draw list--
+        if (!indirect)
+        {
+            queue.collect(scene, culler, lod, view);
+            if (options.sortQueue)
+                queue.sort();
+            else
+                queue.merge();
+        }
+        timer.mark(T_MATRICES);
+
+        timer.beginGpu();
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // one upload of the frame block serves every program, then activate the shader
+        frameUniforms.update(view, projection, camera.Position, animationTime);
+        lightUniforms.update(scene);
+        if (options.clusters)
+            lightClusters.update(scene, view, glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, NEAR_PLANE, FAR_PLANE);
+        ourShader.use();
+        if (options.clusters)
+            lightClusters.bind(ourShader, viewportWidth, viewportHeight);
+        if (indirect)
+            staticRenderer.update(scene, culler.visible, lod, lightCuller);
+        else
+            instanced.update(scene, queue, lightCuller);
+        timer.mark(T_UNIFORMS);
+
+        //------------------Scene------------------
+        if (indirect)
+            staticRenderer.draw(ourShader, arena);
+        else
+            instanced.draw(ourShader, scene, arena);
+
+        // ----------------Fan gurar Condation----------------
+        for (size_t f = 0; f < fans.size(); f++)
+        {
+            // the blades sweep a disc of Fan::REACH around the hub
+            GLuint fanLights[4];
+            lightCuller.listFor(scene, glm::vec3(scene.transforms.world[fans[f].hub][3]), Fan::REACH, fanLights);
+            ourShader.setUVec4(fanLightsUniform.get(ourShader), fanLights);
+            ourShader.setVec3(fanColorUniform.get(ourShader), scene.materials[scene.fans[f].material].color);
+            fans[f].draw(ourShader, fanModelUniform.get(ourShader), fanNormalUniform.get(ourShader), scene.transforms, arena, scene.meshes[scene.fans[f].mesh]);
+        }
+        if (show_timing)
+            overlay.draw(ourShader, frameUniforms, arena, scene.meshes[cubeMesh], timer, SCR_WIDTH, SCR_HEIGHT);
+        timer.mark(T_DRAW);
+    };
+
+    if (options.benchmark)
+    {
+        // fixed-timestep replay of recorded camera input; the fan keeps turning so its
+        // per-frame work is part of the measurement
+        CameraRecording recording = CameraRecording::flythrough();
+        if (!options.replay.empty() && !recording.load(options.replay))
+            return -1;
+        int frames = options.frames > 0 ? options.frames : (int)recording.frames.size();
+        deltaTime = options.timestep;
+        if (window)
+            glfwSwapInterval(0);
+
+        RenderStats totals;
+        double binMilliseconds = 0.0, clusterLights = 0.0, readSeconds = 0.0;
+        float fragmentLights = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            timer.beginFrame();
+            recording.apply(camera, frame, options.timestep);
+            animationTime = frame * options.timestep;
+            timer.mark(T_INPUT);
+
+            renderStats().reset();
+            renderScene();
+            totals.drawCalls += renderStats().drawCalls;
+            totals.stateChanges += renderStats().stateChanges;
+            totals.triangles += renderStats().triangles;
+            totals.culled += renderStats().culled;
+            totals.stateChangesSaved += renderStats().stateChangesSaved;
+            binMilliseconds += lightClusters.binMilliseconds;
+            clusterLights += lightClusters.averageLights;
+            i -= 1;
+
+            // the lights per fragment from the last frame's depth buffer, read before
+            // the swap and kept out of the frame rate
+            if (options.clusters && frame == frames - 1)
+            {
+                auto readStart = std::chrono::steady_clock::now();
+                fragmentLights = lightClusters.lightsPerFragment(viewportWidth, viewportHeight);
+                readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - readStart).count();
+            }
+
+            if (window)
+                glfwSwapBuffers(window);
+            else
+                glFinish();
+            timer.mark(T_SWAP);
+            timer.endFrame();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - readSeconds;
+
+        std::cout << "benchmark: " << frames << " frames, timestep " << options.timestep * 1000.0f << " ms, "
+            << (options.replay.empty() ? "built-in flythrough" : options.replay) << (window ? "" : ", headless") << std::endl;
+        printf("  frames/sec      %10.1f\n", frames / seconds);
+        printf("  draw calls      %10.1f per frame\n", (double)totals.drawCalls / frames);
+        printf("  state changes   %10.1f per frame\n", (double)totals.stateChanges / frames);
+        printf("  sorting saved   %10.1f state changes per frame%s\n", (double)totals.stateChangesSaved / frames,
+            indirect ? " (multi-draw indirect)" : options.sortQueue ? "" : " (sorting off)");
+        printf("  triangles       %10.1f per frame\n", (double)totals.triangles / frames);
+        printf("  culled objects  %10.1f per frame%s%s\n", (double)totals.culled / frames,
+            options.frustumCulling ? "" : " (frustum culling off)", options.portalCulling ? "" : " (portal culling off)");
+        if (options.clusters)
+            printf("  light binning   %10.3f ms per frame, %.1f of %d lights per lit cluster, %.1f per fragment (last frame)\n",
+                binMilliseconds / frames, clusterLights / frames, (int)std::min(scene.lights.size(), (size_t)LightData::MAX_LIGHTS),
+                fragmentLights);
+        else
+            printf("  light lists     %10.1f lights per object (clustering off)\n", lightCuller.averageLights);
+        timer.finish();
+
+        // the GPU query against the wall clock: a GPU-bound frame waits in the swap or
+        // finish about as long as the GPU works on it
+        int measured = 0;
+        for (const FrameSample& sample : timer.history)
+            if (sample.ms[T_GPU] >= 0.0f)
+                measured++;
+        float gpuMs = timer.percentiles(T_GPU).p50;
+        float waitMs = timer.percentiles(T_SWAP).p50;
+        printf("  gpu query       %10.3f ms per frame (p50 of %d frames), %.3f ms wall, %.3f ms in %s\n", gpuMs, measured,
+            1000.0 * seconds / frames, waitMs, window ? "swap" : "glFinish");
+        if (measured > 0 && gpuMs < 0.5f * waitMs)
+            printf("  gpu query covers under half of the wait; the driver's elapsed-time query is not trustworthy here, use frames/sec\n");
+        timer.printSummary();
+    }
+    else if (options.headless)
+    {
+        // scripted walkthrough, every frame is read back and written to disk
+        CameraPath path = CameraPath::walkthrough();
+        if (!options.cameraPath.empty() && !path.load(options.cameraPath))
+            return -1;
+        int frames = options.frames > 0 ? options.frames : 60;
+        int written = 0;
+        std::vector<unsigned char> pixels;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            timer.beginFrame();
+            path.apply(camera, frame, frames);
+            animationTime = frame / 60.0f;
+            timer.mark(T_INPUT);
+            renderScene();
+            headless.readPixels(pixels);
+            bool ok = writeFrame(framePath(options.output, frame), SCR_WIDTH, SCR_HEIGHT, pixels);
+            timer.mark(T_SWAP);
+            timer.endFrame();
+            if (!ok)
+                break;
+            written++;
+        }
+        std::cout << "Wrote " << written << " of " << frames << " frames to " << options.output << std::endl;
+        if (written < frames)
+            exitCode = -1;
+    }
+
+    // --watch: shader and scene files are reloaded while the window stays open. Shaders
+    // are compiled next to the running program, the scene is read on a worker thread,
+    // and either is swapped in between frames only once it loaded without errors.
+    FileWatcher watcher;
+    bool sceneChanged = false;
+    std::future<bool> sceneLoad;
+    SceneGraph nextScene;
+    MeshArena nextArena;
+    if (options.watch)
+    {
+        watcher.watch(ourShader.vertexPath);
+        watcher.watch(ourShader.fragmentPath);
+        if (!options.scene.empty())
+            watcher.watch(options.scene);
+    }
+    auto hotReload = [&]() {
+        for (const std::string& path : watcher.poll())
+        {
+            if (path == options.scene)
+                sceneChanged = true;
+            else if (ourShader.beginReload())
+                std::cout << "Recompiling " << ourShader.vertexPath << " and " << ourShader.fragmentPath << std::endl;
+        }
+        ShaderReload shaderStatus = ourShader.pollReload();
+        if (shaderStatus == RELOAD_DONE)
+            std::cout << "Shader reloaded" << std::endl;
+        else if (shaderStatus == RELOAD_FAILED)
+            std::cout << "Shader reload failed, keeping the previous program" << std::endl;
+
+        if (sceneChanged && !sceneLoad.valid())
+        {
+            sceneChanged = false;
+            nextScene = SceneGraph();
+            nextArena = MeshArena();
+            sceneLoad = std::async(std::launch::async, [&]() {
+                return isTextScenePath(options.scene) ? loadSceneText(options.scene, nextScene, nextArena, buildRoomMeshes, false)
+                    : loadSceneFile(options.scene, nextScene, nextArena, false);
+            });
+        }
+        if (sceneLoad.valid() && sceneLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            if (!sceneLoad.get() || nextScene.findMesh("cube") < 0)
+            {
+                std::cout << "Scene reload failed, keeping the previous scene" << std::endl;
+                return;
+            }
+            size_t bytes = arena.update(nextArena.vertices, nextArena.indices);
+            unsigned int version = scene.version;
+            scene = nextScene;
+            scene.version = version + 1;    // newer than anything built from the old scene
+            cubeMesh = scene.findMesh("cube");
+            buildRoomsAndFans();
+            std::cout << "Reloaded " << options.scene << ", " << bytes << " bytes of geometry uploaded" << std::endl;
+        }
+    };
 
-    // build and compile our shader zprogram
-    Shader ourShader("vertexShader.vs", "fragmentShader.fs");
+    // render loop
+    while (!options.headless && !options.benchmark && !glfwWindowShouldClose(window))
+    {
+        timer.beginFrame();
+
+        // per-frame time logic
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+        animationTime = currentFrame;
+
+        // input
+        frameInput = CameraInput();
+        processInput(window);
+        glfwPollEvents();
+        if (options.watch)
+            hotReload();
+        timer.mark(T_INPUT);
+
+        // render
+        renderScene();
+
+        if (fan_turn)
+            i -= 1;
+        if (rotate_around)
+           moveCamera(Y_LEFT);
+        if (!options.record.empty())
+            recordedInput.frames.push_back(frameInput);
+
+        glfwSwapBuffers(window);
+        timer.mark(T_SWAP);
+        timer.endFrame();
+
+        // the overlay has no text, so the numbers go to the title bar
+        if (show_timing && timer.history.size() % 30 == 0)
+        {
+            Percentiles cpu = timer.percentiles(T_CPU_TOTAL);
+            Percentiles gpu = timer.percentiles(T_GPU);
+            char title[128];
+            snprintf(title, sizeof(title), "LAB FINAL | cpu %.2f/%.2f/%.2f ms | gpu %.2f/%.2f/%.2f ms (p50/p95/p99)",
+                cpu.p50, cpu.p95, cpu.p99, gpu.p50, gpu.p95, gpu.p99);
+            glfwSetWindowTitle(window, title);
+        }
+    }
 
+    if (!options.record.empty())
+        recordedInput.save(options.record);
+
+    timer.finish();
+    if (!options.timingCSV.empty() && !timer.writeCSV(options.timingCSV))
+        exitCode = -1;
+    if (!options.timingJSON.empty() && !timer.writeJSON(options.timingJSON))
+        exitCode = -1;
+    if (!options.benchmark && (!options.timingCSV.empty() || !options.timingJSON.empty()))
+        timer.printSummary();
+    // --------------------****************************************************------------------
+    timer.release();
+    frameUniforms.release();
+    lightUniforms.release();
+    if (options.clusters)
+        lightClusters.release();
+    instanced.release();
+    if (indirect)
+        staticRenderer.release();
+    arena.release();
+
+    headless.release();
+    glfwTerminate();
+    return exitCode;
+}
+
+// ------------------------------------
+// the meshes compiled into the executable; text scene files place instances of them by name
+// ---------------------------------------------------------------------------------------------
+void buildRoomMeshes(SceneGraph& scene, MeshArena& arena)
+{
     // set up vertex data (and buffer(s)) and configure vertex attributes
     
     //axis
@@ -172,222 +691,36 @@ int main()
         22, 23, 20
     };
 
-    float floor[] = {
-        0.0f, 0.0f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.0f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.5f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.5f, 0.0f, 0.57f, 0.69f, 0.57f,
-
-        0.5f, 0.0f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.5f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.0f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.5f, 0.5f, 0.57f, 0.69f, 0.57f,
-
-        0.0f, 0.0f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.0f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.5f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.5f, 0.5f, 0.57f, 0.69f, 0.57f,
-
-        0.0f, 0.0f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.5f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.5f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.0f, 0.0f, 0.57f, 0.69f, 0.57f,
-
-        0.5f, 0.5f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.5f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.5f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.5f, 0.5f, 0.57f, 0.69f, 0.57f,
-
-        0.0f, 0.0f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.0f, 0.0f, 0.57f, 0.69f, 0.57f,
-        0.5f, 0.0f, 0.5f, 0.57f, 0.69f, 0.57f,
-        0.0f, 0.0f, 0.5f, 0.57f, 0.69f, 0.57f
-    };
-    float floor2[] = {
-       0.0f, 0.0f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.0f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.5f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.5f, 0.0f, 0.75f, 0.75f, 0.75f,
-
-       0.5f, 0.0f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.5f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.0f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.5f, 0.5f, 0.75f, 0.75f, 0.75f,
-
-       0.0f, 0.0f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.0f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.5f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.5f, 0.5f, 0.75f, 0.75f, 0.75f,
-
-       0.0f, 0.0f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.5f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.5f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.0f, 0.0f, 0.75f, 0.75f, 0.75f,
-
-       0.5f, 0.5f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.5f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.5f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.5f, 0.5f, 0.75f, 0.75f, 0.75f,
-
-       0.0f, 0.0f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.0f, 0.0f, 0.75f, 0.75f, 0.75f,
-       0.5f, 0.0f, 0.5f, 0.75f, 0.75f, 0.75f,
-       0.0f, 0.0f, 0.5f, 0.75f, 0.75f, 0.75f
-    };
-    float wall1[] = {
-        0.0f, 0.0f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.0f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.5f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.5f, 0.0f, 0.40f, 0.40f, 0.83f,
-
-        0.5f, 0.0f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.5f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.0f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.5f, 0.5f, 0.40f, 0.40f, 0.83f,
-
-        0.0f, 0.0f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.0f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.5f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.5f, 0.5f, 0.40f, 0.40f, 0.83f,
-
-        0.0f, 0.0f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.5f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.5f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.0f, 0.0f, 0.40f, 0.40f, 0.83f,
-
-        0.5f, 0.5f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.5f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.5f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.5f, 0.5f, 0.40f, 0.40f, 0.83f,
-
-        0.0f, 0.0f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.0f, 0.0f, 0.40f, 0.40f, 0.83f,
-        0.5f, 0.0f, 0.5f, 0.40f, 0.40f, 0.83f,
-        0.0f, 0.0f, 0.5f, 0.40f, 0.40f, 0.83f
-    };
-    float wall2[] = {
-        0.0f, 0.0f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.0f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.5f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.5f, 0.0f, 0.40f, 0.40f, 0.75,
-
-        0.5f, 0.0f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.5f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.0f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.5f, 0.5f, 0.40f, 0.40f, 0.75,
-
-        0.0f, 0.0f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.0f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.5f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.5f, 0.5f, 0.40f, 0.40f, 0.75,
-
-        0.0f, 0.0f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.5f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.5f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.0f, 0.0f, 0.40f, 0.40f, 0.75,
-
-        0.5f, 0.5f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.5f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.5f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.5f, 0.5f, 0.40f, 0.40f, 0.75,
-
-        0.0f, 0.0f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.0f, 0.0f, 0.40f, 0.40f, 0.75,
-        0.5f, 0.0f, 0.5f, 0.40f, 0.40f, 0.75,
-        0.0f, 0.0f, 0.5f, 0.40f, 0.40f, 0.75,
-    };
-    float wall3[] = {
-        0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.4f,
-
-        0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.4f,
-
-        0.0f, 0.0f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.5f, 0.0f, 1.0f, 0.4f,
-
-        0.0f, 0.0f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.4f,
-
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.5f, 0.0f, 1.0f, 0.4f,
-
-        0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.5f, 0.0f, 1.0f, 0.4f,
-        0.0f, 0.0f, 0.5f, 0.0f, 1.0f, 0.4f,
-    };
-    float wall4[] = {
-        0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.0f,  0.0f, 1.0f, 0.4f,
-
-        0.5f, 0.0f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.5f,  0.0f, 1.0f, 0.4f,
-
-        0.0f, 0.0f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.5f,  0.0f, 1.0f, 0.4f,
-
-        0.0f, 0.0f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.4f,
-
-        0.5f, 0.5f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.5f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.5f, 0.5f,  0.0f, 1.0f, 0.4f,
-
-        0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.0f,  0.0f, 1.0f, 0.4f,
-        0.5f, 0.0f, 0.5f,  0.0f, 1.0f, 0.4f,
-        0.0f, 0.0f, 0.5f,  0.0f, 1.0f, 0.4f,
-    };
-    float box[] = {
-        0.0f, 0.0f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.0f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.5f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.5f, 0.0f, 0.0f, 0.251f, 0.102f,
-
-        0.5f, 0.0f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.5f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.0f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.5f, 0.5f, 0.0f, 0.251f, 0.102f,
-
-        0.0f, 0.0f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.0f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.5f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.5f, 0.5f, 0.0f, 0.251f, 0.102f,
-
-        0.0f, 0.0f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.5f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.5f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.0f, 0.0f, 0.0f, 0.251f, 0.102f,
-
-        0.5f, 0.5f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.5f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.5f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.5f, 0.5f, 0.0f, 0.251f, 0.102f,
-
-        0.0f, 0.0f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.0f, 0.0f, 0.0f, 0.251f, 0.102f,
-        0.5f, 0.0f, 0.5f, 0.0f, 0.251f, 0.102f,
-        0.0f, 0.0f, 0.5f, 0.0f, 0.251f, 0.102f
+    float cube[] = {
+        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
+
+        0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
+
+        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
+
+        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+
+        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
+
+        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f
     };
     float box2[] = {
         0.0f, 0.0f, 0.0f, 0,0,0,
@@ -420,37 +753,6 @@ int main()
         //0.5f, 0.0f, 0.5f, 0,0,0,
         //0.0f, 0.0f, 0.5f, 0,0,0
     };
-    float ceiling[] = {
-        0.0f, 0.0f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.0f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.5f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.5f, 0.0f, 0.466f, 0.631f, 0.827f,
-
-        0.5f, 0.0f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.5f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.0f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.5f, 0.5f, 0.466f, 0.631f, 0.827f,
-
-        0.0f, 0.0f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.0f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.5f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.5f, 0.5f, 0.466f, 0.631f, 0.827f,
-
-        0.0f, 0.0f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.5f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.5f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.0f, 0.0f, 0.466f, 0.631f, 0.827f,
-
-        0.5f, 0.5f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.5f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.5f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.5f, 0.5f, 0.466f, 0.631f, 0.827f,
-
-        0.0f, 0.0f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.0f, 0.0f, 0.466f, 0.631f, 0.827f,
-        0.5f, 0.0f, 0.5f, 0.466f, 0.631f, 0.827f,
-        0.0f, 0.0f, 0.5f, 0.466f, 0.631f, 0.827f
-    };
     float lamp_ver[] = {
        
 
@@ -484,137 +786,6 @@ int main()
        0.5f, 0.0f, 0.5f, 0.96, .89, .26,
        0.0f, 0.0f, 0.5f, 0.96, .89, .26,
     };
-    float fan_holder[] = {
-        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
-
-        0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
-
-        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
-
-        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-
-        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.5f, 0.5f, 1.0f, 1.0f, 1.0f,
-
-        0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
-        0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,
-        0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f
-    };
-    float fan_pivot[] = {
-        0.0f, 0.0f, 0.0f, .44f, .22f, .05f,
-        0.5f, 0.0f, 0.0f, .44f, .22f, .05f,
-        0.5f, 0.5f, 0.0f, .44f, .22f, .05f,
-        0.0f, 0.5f, 0.0f, .44f, .22f, .05f,
-
-        0.5f, 0.0f, 0.0f, .44f, .22f, .05f,
-        0.5f, 0.5f, 0.0f, .44f, .22f, .05f,
-        0.5f, 0.0f, 0.5f, .44f, .22f, .05f,
-        0.5f, 0.5f, 0.5f, .44f, .22f, .05f,
-
-        0.0f, 0.0f, 0.5f, .44f, .22f, .05f,
-        0.5f, 0.0f, 0.5f, .44f, .22f, .05f,
-        0.5f, 0.5f, 0.5f, .44f, .22f, .05f,
-        0.0f, 0.5f, 0.5f, .44f, .22f, .05f,
-
-        0.0f, 0.0f, 0.5f, .44f, .22f, .05f,
-        0.0f, 0.5f, 0.5f, .44f, .22f, .05f,
-        0.0f, 0.5f, 0.0f, .44f, .22f, .05f,
-        0.0f, 0.0f, 0.0f, .44f, .22f, .05f,
-
-        0.5f, 0.5f, 0.5f, .44f, .22f, .05f,
-        0.5f, 0.5f, 0.0f, .44f, .22f, .05f,
-        0.0f, 0.5f, 0.0f, .44f, .22f, .05f,
-        0.0f, 0.5f, 0.5f, .44f, .22f, .05f,
-
-        0.0f, 0.0f, 0.0f, .44f, .22f, .05f,
-        0.5f, 0.0f, 0.0f, .44f, .22f, .05f,
-        0.5f, 0.0f, 0.5f, .44f, .22f, .05f,
-        0.0f, 0.0f, 0.5f, .44f, .22f, .05f
-    };
-    float fan_blade[] = {
-        0.0f, 0.0f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.0f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.5f, 0.0f, .0f, .0f, .42f,
-        0.0f, 0.5f, 0.0f, .0f, .0f, .42f,
-
-        0.5f, 0.0f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.5f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.0f, 0.5f, .0f, .0f, .42f,
-        0.5f, 0.5f, 0.5f, .0f, .0f, .42f,
-
-        0.0f, 0.0f, 0.5f, .0f, .0f, .42f,
-        0.5f, 0.0f, 0.5f, .0f, .0f, .42f,
-        0.5f, 0.5f, 0.5f, .0f, .0f, .42f,
-        0.0f, 0.5f, 0.5f, .0f, .0f, .42f,
-
-        0.0f, 0.0f, 0.5f, .0f, .0f, .42f,
-        0.0f, 0.5f, 0.5f, .0f, .0f, .42f,
-        0.0f, 0.5f, 0.0f, .0f, .0f, .42f,
-        0.0f, 0.0f, 0.0f, .0f, .0f, .42f,
-
-        0.5f, 0.5f, 0.5f, .0f, .0f, .42f,
-        0.5f, 0.5f, 0.0f, .0f, .0f, .42f,
-        0.0f, 0.5f, 0.0f, .0f, .0f, .42f,
-        0.0f, 0.5f, 0.5f, .0f, .0f, .42f,
-
-        0.0f, 0.0f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.0f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.0f, 0.5f, .0f, .0f, .42f,
-        0.0f, 0.0f, 0.5f, .0f, .0f, .42f
-    };
-    float glass[] = {//window
-        0.0f, 0.0f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.0f, 0.0f, .0f, .0f, .42f,
-        0.5f, 0.5f, 0.0f, .0f, .0f, .42f,
-        0.0f, 0.5f, 0.0f, .0f, .0f, .42f,
-
-    };
-    float tv1[] = {
-        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
-
-        0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-
-        0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-
-        0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-
-        0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f,
-
-        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f,
-    };
     /*******************AC********************/
     float ac[] = {
         0.0f, 0.0f, 0.0f,0.2f, 0.2f, 0.2f,
@@ -649,995 +820,387 @@ int main()
     };
 
 
-    unsigned int VBOCA, VAOCA, EBOCA;
-    glGenVertexArrays(1, &VAOCA);
-    glGenBuffers(1, &VBOCA);
-    glGenBuffers(1, &EBOCA);
-    glBindVertexArray(VAOCA);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOCA);
-    //glBufferData(GL_ARRAY_BUFFER, sizeof(cabinate), cabinate, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOCA);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBOT, VAOT, EBOT;
-    glGenVertexArrays(1, &VAOT);
-    glGenBuffers(1, &VBOT);
-    glGenBuffers(1, &EBOT);
-    glBindVertexArray(VAOT);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOT);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(ceiling), ceiling, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOT);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
+    // every mesh is sub-allocated from one shared vertex/index buffer
+    GLuint cubeIndices = arena.addIndices(cube_indices, 36);
+    GLint cubeBase = arena.addVertices(cube, 24);
+    GLint box2Base = arena.addVertices(box2, 20);
+    GLint lampBase = arena.addVertices(lamp_ver, 24);
+    GLint acBase = arena.addVertices(ac, 24);
+
+    scene.addMesh(GL_TRIANGLES, 36, cubeIndices, cubeBase, "cube");
+    scene.addMesh(GL_LINE_LOOP, 12, cubeIndices, cubeBase, "outline");
+    scene.addMesh(GL_TRIANGLES, 30, cubeIndices, box2Base, "box2");    // box2 has no bottom face
+    scene.addMesh(GL_TRIANGLES, 36, cubeIndices, lampBase, "lamp");
+    scene.addMesh(GL_TRIANGLES, 36, cubeIndices, acBase, "ac");
+    arena.computeNormals(GL_TRIANGLES, cubeIndices, 36, cubeBase);
+    arena.computeNormals(GL_TRIANGLES, cubeIndices, 30, box2Base);
+    arena.computeNormals(GL_TRIANGLES, cubeIndices, 36, lampBase);
+    arena.computeNormals(GL_TRIANGLES, cubeIndices, 36, acBase);
+
+    // round legs and stands: fills the same 0.5 box as the cube, at four levels of
+    // detail switched by projected size
+    static const int cylinderSectors[] = { 32, 16, 8, 6 };
+    static const float cylinderBelow[] = { 0.25f, 0.08f, 0.03f };
+    int previous = -1;
+    for (int level = 0; level < 4; level++)
+    {
+        Cylinders cylinder = Cylinders::cylinder(0.25f, 0.5f, cylinderSectors[level]);
+        cylinder.center = glm::vec3(0.25f, 0.0f, 0.25f);
+        GLint cylinderBase;
+        GLuint cylinderIndices;
+        float* cylinderVertices = arena.allocateVertices(cylinder.vertexCount(), cylinderBase);
+        cylinder.generate(cylinderVertices, arena.allocateIndices(cylinder.indexCount(), cylinderIndices), VertexLayout::arena());
+        int mesh = scene.addMesh(GL_TRIANGLES, cylinder.indexCount(), cylinderIndices, cylinderBase,
+            level == 0 ? "cylinder" : "cylinder_lod" + std::to_string(level));
+        if (previous >= 0)
+            scene.setLod(previous, mesh, cylinderBelow[level - 1]);
+        previous = mesh;
+    }
+}
 
-    
-    unsigned int VBOLMP, VAOLMP, EBOLMP;
-    glGenVertexArrays(1, &VAOLMP);
-    glGenBuffers(1, &VBOLMP);
-    glGenBuffers(1, &EBOLMP);
-    glBindVertexArray(VAOLMP);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOLMP);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(lamp_ver), lamp_ver, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOLMP);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBOG, VAOG, EBOG;
-    glGenVertexArrays(1, &VAOG);
-    glGenBuffers(1, &VBOG);
-    glGenBuffers(1, &EBOG);
-    glBindVertexArray(VAOG);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOG);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(floor), floor, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOG);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-    /*----------------   floor2   -----------------*/
-    unsigned int VBODD, VAODD, EBODD;
-    glGenVertexArrays(1, &VAODD);
-    glGenBuffers(1, &VBODD);
-    glGenBuffers(1, &EBODD);
-    glBindVertexArray(VAODD);
-    glBindBuffer(GL_ARRAY_BUFFER, VBODD);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(floor2), floor2, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBODD);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBOW, VAOW, EBOW;
-    glGenVertexArrays(1, &VAOW);
-    glGenBuffers(1, &VBOW);
-    glGenBuffers(1, &EBOW);
-    glBindVertexArray(VAOW);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOW);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wall1), wall1, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-    //*********************Wall3************************************
-    unsigned int VBOQ, VAOQ, EBOQ;
-    glGenVertexArrays(1, &VAOQ);
-    glGenBuffers(1, &VBOQ);
-    glGenBuffers(1, &EBOQ);
-    glBindVertexArray(VAOQ);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOQ);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wall3), wall3, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOQ);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-    //*******************************************************************
-
-    unsigned int VBOW1, VAOW1, EBOW1;
-    glGenVertexArrays(1, &VAOW1);
-    glGenBuffers(1, &VBOW1);
-    glGenBuffers(1, &EBOW1);
-    glBindVertexArray(VAOW1);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOW1);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wall2), wall2, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOW1);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-    //******************  Wall4 -------------------
-    unsigned int VBOWY, VAOWY, EBOWY;
-    glGenVertexArrays(1, &VAOWY);
-    glGenBuffers(1, &VBOWY);
-    glGenBuffers(1, &EBOWY);
-    glBindVertexArray(VAOWY);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOWY);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wall4), wall4, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOWY);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-    //*****************************  AC  ****************************************
-    unsigned int VBOAC, VAOAC, EBOAC;
-    glGenVertexArrays(1, &VAOAC);
-    glGenBuffers(1, &VBOAC);
-    glGenBuffers(1, &EBOAC);
-    glBindVertexArray(VAOAC);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOAC);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(ac), ac, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOAC);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-    /*---------------------------------------------------------------------*/
-
-    unsigned int VBOC, VAOC, EBOC;
-    glGenVertexArrays(1, &VAOC);
-    glGenBuffers(1, &VBOC);
-    glGenBuffers(1, &EBOC);
-    glBindVertexArray(VAOC);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOC);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(box), box, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOC);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBOC2, VAOC2, EBOC2;
-    glGenVertexArrays(1, &VAOC2);
-    glGenBuffers(1, &VBOC2);
-    glGenBuffers(1, &EBOC2);
-    glBindVertexArray(VAOC2);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOC2);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(box2), box2, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOC2);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBOTV, VAOTV, EBOTV;
-    glGenVertexArrays(1, &VAOTV);
-    glGenBuffers(1, &VBOTV);
-    glGenBuffers(1, &EBOTV);
-    glBindVertexArray(VAOTV);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOTV);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tv1), tv1, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOTV);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    //Fan
-    unsigned int VBOF1, VAOF1, EBOF1;
-    glGenVertexArrays(1, &VAOF1);
-    glGenBuffers(1, &VBOF1);
-    glGenBuffers(1, &EBOF1);
-    glBindVertexArray(VAOF1);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOF1);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(fan_holder), fan_holder, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOF1);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBOF2, VAOF2, EBOF2;
-    glGenVertexArrays(1, &VAOF2);
-    glGenBuffers(1, &VBOF2);
-    glGenBuffers(1, &EBOF2);
-    glBindVertexArray(VAOF2);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOF2);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(fan_pivot), fan_pivot, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOF2);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-
-    unsigned int VBOF3, VAOF3, EBOF3;
-    glGenVertexArrays(1, &VAOF3);
-    glGenBuffers(1, &VBOF3);
-    glGenBuffers(1, &EBOF3);
-    glBindVertexArray(VAOF3);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOF3);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(fan_blade), fan_blade, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOF3);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    //color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-    
+// ------------------------------------
+// the dining room / bedroom / room3 scene as it is compiled into the executable
+// ---------------------------------------------------------------------------------------------
+void buildRoomScene(SceneGraph& scene, MeshArena& arena)
+{
+    // scene: every object is a node in one flat array, built once and walked by the render loop
+    buildRoomMeshes(scene, arena);
+    int cubeMesh = scene.findMesh("cube");
+    int outlineMesh = scene.findMesh("outline");
+    int box2Mesh = scene.findMesh("box2");
+    int lampMesh = scene.findMesh("lamp");
+    int acMesh = scene.findMesh("ac");
+    int cylinderMesh = scene.findMesh("cylinder");
+
+    int matG = scene.addMaterial(glm::vec3(0.57f, 0.69f, 0.57f), "floor");
+    int matT = scene.addMaterial(glm::vec3(0.466f, 0.631f, 0.827f), "ceiling");
+    int matW = scene.addMaterial(glm::vec3(0.40f, 0.40f, 0.83f), "wall1");
+    int matQ = scene.addMaterial(glm::vec3(0.0f, 1.0f, 0.4f), "wall3");
+    int matW1 = scene.addMaterial(glm::vec3(0.40f, 0.40f, 0.75f), "wall2");
+    int matWY = scene.addMaterial(glm::vec3(0.0f, 1.0f, 0.4f), "wall4");
+    int matDD = scene.addMaterial(glm::vec3(0.75f, 0.75f, 0.75f), "floor2");
+    int matF2 = scene.addMaterial(glm::vec3(0.44f, 0.22f, 0.05f), "fan_pivot");
+    int matTV = scene.addMaterial(glm::vec3(0.0f, 0.0f, 0.0f), "tv1");
+    int matC = scene.addMaterial(glm::vec3(0.0f, 0.251f, 0.102f), "box");
+    int matF1 = scene.addMaterial(glm::vec3(1.0f, 1.0f, 1.0f), "fan_holder");
+    int matF3 = scene.addMaterial(glm::vec3(0.0f, 0.0f, 0.42f), "fan_blade");
+    int matBaked = scene.addMaterial(glm::vec3(1.0f), "baked");               // box2, lamp and ac keep their vertex colours
+
+    //------------------Furniture, each piece defined once around its own origin------------------
+    int sofa = scene.addComposite("sofa");
+    //-----------------sofa 1 er boshar part---------------
+    scene.addPart(sofa, cubeMesh, matC, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 1.5, 6);
+    //-----------------sofa 1 er pichoner part---------------
+    scene.addPart(sofa, cubeMesh, matC, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 4, 6);
+    //-----------------sofa 1 er left er corner part---------------
+    scene.addPart(sofa, cubeMesh, matF2, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 3, -1);
+    //-----------------sofa 1 er black cover part---------------
+    scene.addPart(sofa, box2Mesh, matBaked, 0, 1.5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 0.1, -1);
+    scene.addPart(sofa, box2Mesh, matBaked, -1.5, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.1, 3.1, -1);
+    //right er corner
+    scene.addPart(sofa, cubeMesh, matF2, 0, 0, 3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 3, 1);
+    scene.addPart(sofa, box2Mesh, matBaked, 0, 1.5, 3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 0.1, 1);
+    scene.addPart(sofa, box2Mesh, matBaked, -1.5, 0, 3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.1, 3.1, 1);
+    //cover
+    scene.addPart(sofa, cubeMesh, matW, 0, .75, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 0.5, 6);
+
+    int bed = scene.addComposite("bed");
+    //-----------------sofa 1 er boshar part---------------
+    scene.addPart(bed, cubeMesh, matF2, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 6, 1.2, 6);
+    //-----------------bed er pichoner part---------------
+    scene.addPart(bed, cubeMesh, matF2, 3, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 3, 6);
+    //cover
+    scene.addPart(bed, cubeMesh, matF1, 0, .6, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 5.2, 0.5, 6);
+    //balish
+    scene.addPart(bed, cubeMesh, matQ, 1.8, .6, .1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.5, 0.9, 2);
+    //balish
+    scene.addPart(bed, cubeMesh, matQ, 1.8, .6, 1.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.5, 0.9, 2);
+
+    int floorLamp = scene.addComposite("floor lamp");
+    scene.addPart(floorLamp, lampMesh, matBaked, 0, 1.75, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 2.35, 1.2);
+    //*------------------lamp stand---------------------*
+    scene.addPart(floorLamp, cylinderMesh, matTV, .3, 0, .25, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .15, 4, .15);
+    //*------------------lamp stand er nicar part---------------------*
+    scene.addPart(floorLamp, cubeMesh, matTV, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 0.5, 1.2);
+
+    int tableLamp = scene.addComposite("table lamp");
+    //********************--Lamp--*******************
+    scene.addPart(tableLamp, lampMesh, matBaked, 0, .75, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 2, 1.2);
+    //*------------------lamp stand---------------------*
+    scene.addPart(tableLamp, cylinderMesh, matTV, .25, 0, .25, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .15, 2, .15);
+    //*------------------lamp stand er nicar part---------------------*
+    scene.addPart(tableLamp, cubeMesh, matTV, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 0.2, 1.2);
+
+    int longSofa = scene.addComposite("long sofa");
+    //-------------sofa2 boshar base-------
+    scene.addPart(longSofa, cubeMesh, matC, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -9, 1.5, -3);
+    //------------sofar black cover----------------
+    scene.addPart(longSofa, box2Mesh, matBaked, 0, 1.5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 0.1, -3);
+    scene.addPart(longSofa, box2Mesh, matBaked, 0, 0, -1.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 3.1, -.1);
+    //----------sofar right er corner--------------
+    scene.addPart(longSofa, cubeMesh, matF2, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 3, -3);
+    //-------------sofar left er corner------------
+    scene.addPart(longSofa, cubeMesh, matF2, -4.5, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 3, -3);
+    //-------------sofar black cover------------
+    scene.addPart(longSofa, box2Mesh, matBaked, -4.5, 1.5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 0.1, -3);
+    scene.addPart(longSofa, box2Mesh, matBaked, -4.5, 0, -1.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 3.1, -.1);
+    //---------------sofar pichoner base--------------
+    scene.addPart(longSofa, cubeMesh, matC, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -9, 4, -1);
+    //--------------1st sofa bed -----------------
+    scene.addPart(longSofa, cubeMesh, matW, 0, .75, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -9, 0.5, -3);
+
+    int diningTable = scene.addComposite("dining table");
+    scene.addPart(diningTable, cubeMesh, matTV, 0, .6, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6, .8, 3);
+    // ----------------Tablem er samner left leg --------------------
+    scene.addPart(diningTable, cubeMesh, matTV, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.3, 1.2, .3);
+    // ----------------Tablem er samner right leg --------------------
+    scene.addPart(diningTable, cubeMesh, matTV, -3, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, .3);
+    // ----------------Table er pichoner left leg --------------------
+    scene.addPart(diningTable, cubeMesh, matTV, 0, 0, 1.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.3, 1.2, -.3);
+    // ----------------Table er pichoner right leg --------------------
+    scene.addPart(diningTable, cubeMesh, matTV, -3, 0, 1.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
+    // ----------------Table er uporar part--------------------
+    scene.addPart(diningTable, cubeMesh, matF2, .05, 1, -.05, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .4, 3.2);
+
+    int table = scene.addComposite("table");
+    scene.addPart(table, cubeMesh, matF2, 0, .6, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 6, .6, 3);
+    // ----------------Tablem er samner left leg --------------------
+    scene.addPart(table, cubeMesh, matTV, .2, 0, .1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, .3);
+    // ----------------Tablem er samner right leg --------------------
+    scene.addPart(table, cubeMesh, matTV, .2, 0, 1.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, .3);
+    // ----------------Table er pichoner left leg --------------------
+    scene.addPart(table, cubeMesh, matTV, 2.7, 0, .1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
+    // ----------------Table er pichoner right leg --------------------
+    scene.addPart(table, cubeMesh, matTV, 2.7, 0, 1.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
+    // ----------------Table er uporar part--------------------
+    scene.addPart(table, cubeMesh, matF1, 0, .9, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 6, .1, 3);
+
+    int fan = scene.addComposite("fan");
+    // ----------------Fan er uporer part---------------
+    scene.addPart(fan, cubeMesh, matF1, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, -.2, 1);
+    // ----------------Fan er hanger--------------------
+    scene.addPart(fan, cylinderMesh, matC, .2125, -.1, .2125, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .15, -1, .15);
+    // ----------------Fan er nicher part-----------------
+    scene.addPart(fan, cubeMesh, matC, 0, -.6, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, -.33, 1);
+    //nicher
+    scene.addPart(fan, cubeMesh, matF1, 0, -.775, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, -.05, 1);
+
+    //***********************************************************************************************
+    //------------------Floor------------------
+    scene.addNode(cubeMesh, matG, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 0.1, 20);
+
+    //--------------Roof----------------------
+    scene.addNode(cubeMesh, matT, 0, 5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 0.1, 20);
+
+    //-----------------------Wall1 left --------------
+    scene.addNode(cubeMesh, matW, 0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 10, 0.1);
+
+    //-----------------------Wall1 Right ---------------
+    scene.addNode(cubeMesh, matW, 0, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 10, 0.1);
+    //***************************   wall3  ***************************
+     //-----------------------Wall3  --------------
+
+    //2nd door er left side
+    scene.addNode(cubeMesh, matQ, 11.45, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 22.2, 10, 0.1);
+    //2nd door er uporar part
+    scene.addNode(cubeMesh, matQ, 10, 3.34, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 4.8, 3.3, 0.1);
+
+    //-----------------------2room er Wall3 Right ---------------
+    scene.addNode(cubeMesh, matQ, 10, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 10, 0.1);
+    //****************************************************************
+
+
+    //------------------------door er sather Wall2--------------------
+    //door er left side er door
+    scene.addNode(cubeMesh, matW1, 10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, 0.15);
+    //Door er uporar wall
+    scene.addNode(cubeMesh, matW1, 10, 3.355, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 3.3, 4.2);
+    //door er right side er wall
+    scene.addNode(cubeMesh, matW1, 10, 0, 2.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, 15.8);
+
+
+    ///*-----------------wall4 ------------------*/
+    scene.addNode(cubeMesh, matWY, 22.5, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, 20);
+
+    //------------------Floor2 for room2------------------
+    scene.addNode(cubeMesh, matDD, 10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, 20);
+
+    ////--------------Roof for room2----------------------
+    scene.addNode(cubeMesh, matT, 10, 5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, 20);
+    //****************************************************************************************************
+
+    //-----------Rak 1------------
+    scene.addNode(cubeMesh, matF2, 6.05, 1, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .15, 2.12);
+
+    //-----------Rak 2------------
+    scene.addNode(cubeMesh, matF2, 6.05, .5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .15, 2.12);
+
+    //-----------Rak 3------------
+    scene.addNode(cubeMesh, matF2, 6.05, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .15, 2.12);
+
+
+    //------------------tv---------------------
+    scene.addNode(cubeMesh, matTV, 5.60, 1.4, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -4.5, 2.75, 0.2);
+
+    //------------------Room2 tv---------------------
+    scene.addNode(cubeMesh, matTV, 10.1, 3, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, 4, 6);
+    //TV stand
+    scene.addNode(cubeMesh, matTV, 10.1, 3, 5.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
+    //TV stand
+    scene.addNode(cubeMesh, matTV, 10.1, 3, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
+    //TV stand
+    scene.addNode(cubeMesh, matTV, 10.1, 3, 7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
+    //TV stand
+    scene.addNode(cubeMesh, matTV, 10.1, 3, 7.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
 
-    unsigned int VBOS, VAOS, EBOS;
-    glGenVertexArrays(1, &VAOS);
-    glGenBuffers(1, &VBOS);
-    glGenBuffers(1, &EBOS);
-    glBindVertexArray(VAOS);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOS);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glass), glass, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOS);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
+    //-----------------TV Rakar Rak---------------
+    scene.addNode(cubeMesh, matF2, 10.1, 2.5, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .5, .2, 6);
 
-    // ---position attribute--
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
 
-    //---color attribute--
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
+    //------------------DOOR----------------
+    scene.addNode(outlineMesh, matTV, 11.45, 0.1, 0.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 6.5, 4);
 
-    int i = 0;
+    ////-----------DOOR er handle-----------------
+    //scene.addNode(cubeMesh, matTV, 9.9, 1.8, 2.0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -0.2, 0.7, -0.1);
 
+    ////-----------DOOR er handle-----------------
+    //scene.addNode(cubeMesh, matTV, 11.3, 1.8, 0.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -0.2, 0.7, -0.1);
 
-    // render loop
-    while (!glfwWindowShouldClose(window))
-    {
-        // per-frame time logic
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+    //-----------------------sofa 1------------------
+    scene.instantiate(sofa, 10, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
 
-        // input
-        processInput(window);
+    /*-----------------bed Room2*/
+    scene.instantiate(bed, 19.5, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
 
-        // render
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    //manus
+    scene.addNode(cubeMesh, matT, 19.5, 0.87, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .8, 1.3, 1.5);
+    //gola
+    scene.addNode(cubeMesh, matTV, 19.7, 1.5, 6.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .2, 0.7, .2);
+    //matha
+    scene.addNode(cubeMesh, matF1, 19.5, 1.7, 5.95, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .7, 0.5, .8);
+    //lag
+    scene.addNode(cubeMesh, matTV, 19.1, 0.0, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .2, 1.7, .2);
+    //lag
+    scene.addNode(cubeMesh, matTV, 19.1, 0.0, 6.4, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .2, 1.7, .2);
+    //hand
+    scene.addNode(cubeMesh, matTV, 19.1, 1.2, 6.4, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .8, .2, .2);
+    //hand
+    scene.addNode(cubeMesh, matTV, 19.1, 1.2, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .8, .2, .2);
+    //lag
+    scene.addNode(cubeMesh, matTV, 19.1, 0.84, 6.4, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .9, .2, .2);
+    //lag
+    scene.addNode(cubeMesh, matTV, 19.1, 0.84, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .9, .2, .2);
 
-        // activate shader
-        ourShader.use();
-        glm::mat4 model,rotate,scale;
-        // pass projection matrix to shader (note that in this case it could change every frame)
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        ourShader.setMat4("projection", projection);
+    /*------------------------- ROOM2 AC setup -------------------*/
+    //AC
+    scene.addNode(acMesh, matBaked, 22.5, 4, 6, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -5, 2, 6);
 
-        // ---camera/view transformation--
-        glm::mat4 view = camera.GetViewMatrix();
-        ourShader.setMat4("view", view);
-
-        //***********************************************************************************************
-        //------------------Floor------------------
-        model = transforamtion(0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 0.1, 20);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOG);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //--------------Roof----------------------
-        model = transforamtion(0, 5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 0.1, 20);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOT);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------------------Wall1 left --------------
-        model = transforamtion(0, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 10, 0.1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------------------Wall1 Right ---------------
-        model = transforamtion(0, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 20, 10, 0.1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //***************************   wall3  ***************************
-         //-----------------------Wall3  --------------
-
-        //2nd door er left side
-        model = transforamtion(11.45, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 22.2, 10, 0.1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOQ);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //2nd door er uporar part
-        model = transforamtion(10, 3.34, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 4.8, 3.3, 0.1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOQ);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------------------2room er Wall3 Right ---------------
-        model = transforamtion(10, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 10, 0.1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOQ);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //****************************************************************
-
-
-        //------------------------door er sather Wall2--------------------
-        //door er left side er door
-        model = transforamtion(10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, 0.15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //Door er uporar wall
-        model = transforamtion(10, 3.355, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 3.3, 4.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //door er right side er wall
-        model = transforamtion(10, 0, 2.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, 15.8);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-
-        ///*-----------------wall4 ------------------*/
-        model = transforamtion(22.5, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, 20);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VBOWY);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //------------------Floor2 for room2------------------
-        model = transforamtion(10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, 20);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAODD);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        ////--------------Roof for room2----------------------
-        model = transforamtion(10, 5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, 20);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOT);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //****************************************************************************************************
-        
-        //-----------Rak 1------------
-        model = transforamtion(6.05, 1, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .15, 2.12);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------Rak 2------------
-        model = transforamtion(6.05, .5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .15, 2.12);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------Rak 3------------
-        model = transforamtion(6.05, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .15, 2.12);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-
-        //------------------tv---------------------
-        model = transforamtion(5.60, 1.4, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -4.5, 2.75, 0.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //------------------Room2 tv---------------------
-        model = transforamtion(10.1, 3, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, 4, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //TV stand
-        model = transforamtion(10.1, 3, 5.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //TV stand
-        model = transforamtion(10.1, 3, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //TV stand
-        model = transforamtion(10.1, 3, 7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //TV stand
-        model = transforamtion(10.1, 3, 7.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .1, -1, .1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------------TV Rakar Rak---------------
-       model = transforamtion(10.1, 2.5, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .5, .2, 6);
-       ourShader.setMat4("model", model);
-       glBindVertexArray(VAOF2);
-       glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-
-        //------------------DOOR----------------
-        model = transforamtion(11.45, 0.1, 0.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 6.5, 4);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_LINE_LOOP, 12, GL_UNSIGNED_INT, 0);
-
-        ////-----------DOOR er handle-----------------
-        //model = transforamtion(9.9, 1.8, 2.0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -0.2, 0.7, -0.1);
-        //ourShader.setMat4("model", model);
-        //glBindVertexArray(VAOTV);
-        //glDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_INT, 0);
-
-        ////-----------DOOR er handle-----------------
-        //model = transforamtion(11.3, 1.8, 0.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -0.2, 0.7, -0.1);
-        //ourShader.setMat4("model", model);
-        //glBindVertexArray(VAOTV);
-        //glDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_INT, 0);
-
-        //-----------------------sofa 1------------------
-        //-----------------sofa 1 er boshar part---------------
-        model = transforamtion(10, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 1.5, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
- 
-        //-----------------sofa 1 er pichoner part---------------
-        model = transforamtion(10, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 4, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------------sofa 1 er left er corner part---------------
-        model = transforamtion(10, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 3, -1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-----------------sofa 1 er black cover part---------------
-        model = transforamtion(10, 1.5, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 0.1, -1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(8.5, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.1, 3.1, -1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //right er corner
-        model = transforamtion(10, 0, 8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 3, 1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(10, 1.5, 8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 0.1, 1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(8.5, 0, 8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.1, 3.1, 1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //cover
-        model = transforamtion(10, 0.75, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -3, 0.5, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        /*-----------------bed Room2*/
-                //-----------------sofa 1 er boshar part---------------
-        model = transforamtion(19.5, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 6, 1.2, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //-----------------bed er pichoner part---------------
-        model = transforamtion(22.5, 0, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 3, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //cover
-        model = transforamtion(19.5, 0.60, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 5.2, 0.5, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //balish
-        model = transforamtion(21.3, 0.60, 5.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.5, 0.9, 2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOQ);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //balish
-        model = transforamtion(21.3, 0.60, 6.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.5, 0.9, 2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOQ);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //manus
-        model = transforamtion(19.5, 0.87, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .8, 1.3, 1.5);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOT);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //gola
-        model = transforamtion(19.7, 1.5, 6.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .2, 0.7, .2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //matha
-        model = transforamtion(19.5, 1.7, 5.95, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .7, 0.5, .8);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //lag
-        model = transforamtion(19.1, 0.0, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .2, 1.7, .2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //lag
-        model = transforamtion(19.1, 0.0, 6.4, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .2, 1.7, .2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //hand
-        model = transforamtion(19.1, 1.2, 6.4, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .8, .2, .2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //hand
-        model = transforamtion(19.1, 1.2, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .8, .2, .2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //lag
-        model = transforamtion(19.1, 0.84, 6.4, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .9, .2, .2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //lag
-        model = transforamtion(19.1, 0.84, 5.8, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .9, .2, .2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        /*------------------------- ROOM2 AC setup -------------------*/
-        //AC
-        model = transforamtion(22.5, 4, 6, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -5, 2, 6);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOAC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-
-        //------------------------paposh-----------------------   
-        model = transforamtion(5.8, 0, 2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -8, 0.2, 8);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        
-
-        //********************--Lamp--*******************
-        model = transforamtion(8.5, 1.75,3.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 2.35, 1.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOLMP);
-        glDrawElements(GL_TRIANGLES, 96, GL_UNSIGNED_INT, 0);
-
-        //*------------------lamp stand---------------------*
-        model = transforamtion(8.8, 0, 3.75, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .15, 4, .15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //*------------------lamp stand er nicar part---------------------*
-        model = transforamtion(8.5, 0, 3.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 0.5, 1.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 96, GL_UNSIGNED_INT, 0);
-        /*--------------Room2 Lamp-----------------*/
-        //********************--Lamp--*******************
-        model = transforamtion(21, 1.75, .5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 2, 1.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOLMP);
-        glDrawElements(GL_TRIANGLES, 96, GL_UNSIGNED_INT, 0);
-
-        //*------------------lamp stand---------------------*
-        model = transforamtion(21.25, 1.0, .75, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .15, 2, .15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //*------------------lamp stand er nicar part---------------------*
-        model = transforamtion(21, 1.0, .5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1.2, 0.2, 1.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 96, GL_UNSIGNED_INT, 0);
-   
-        
-        
-        //-------------sofa 2-----------------
-        //-------------sofa2 boshar base-------
-        model = transforamtion(6.6, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -9, 1.5, -3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //------------sofar black cover----------------
-        model = transforamtion(6.6, 1.5, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 0.1, -3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        model = transforamtion(6.6, 0, 8.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 3.1, -.1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //----------sofar right er corner--------------
-        model = transforamtion(6.6, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 3, -3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-------------sofar left er corner------------
-        model = transforamtion(2.1, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 3, -3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //-------------sofar black cover------------
-        model = transforamtion(2.1, 1.5, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 0.1, -3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(2.1, 0, 8.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -1, 3.1, -.1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //---------------sofar pichoner base--------------
-        model = transforamtion(6.6, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -9, 4, -1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //--------------1st sofa bed -----------------
-        model = transforamtion(6.6, 0.75, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -9, 0.5, -3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        //*******************window*********************
-        //----------------------pordar hanger--------------------------
-        model = transforamtion(2.65, 4, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 8.4, 1, -.5);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // -----------------window porson glass black--------------
-        model = transforamtion(3, 1.5, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 7, 5, -.15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        /*--------------ROOM2 ----------------*/
-         //----------------------pordar hanger--------------------------
-        model = transforamtion(15.65, 4, 0.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 8.4, 1, -.5);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // -----------------window porson glass black--------------
-        model = transforamtion(16, 1.5, 0.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 7, 5, -.15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        /*--------------------------------------------------*/
-
-        // ----------------**Table**--------------------
-        model = transforamtion(5.8, 0.6, 6.2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6, .8, 3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Tablem er samner left leg --------------------
-        model = transforamtion(5.8, 0.0, 6.2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.3, 1.2, .3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Tablem er samner right leg --------------------
-        model = transforamtion(2.8, 0.0, 6.2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, .3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Table er pichoner left leg --------------------
-
-        model = transforamtion(5.8, 0.0, 7.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -.3, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Table er pichoner right leg --------------------
-        model = transforamtion(2.8, 0.0, 7.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Table er uporar part--------------------
-        model = transforamtion(5.85, 1, 6.15, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .4, 3.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------**Room 2 Table**--------------------
-        model = transforamtion(19.5, 0.6, 0.2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 6, .6, 3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF2);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Tablem er samner left leg --------------------
-        model = transforamtion(19.7, 0.0, 0.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, .3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Tablem er samner right leg --------------------
-        model = transforamtion(19.7, 0.0, 1.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, .3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Table er pichoner left leg --------------------
-
-        model = transforamtion(22.2, 0.0, 0.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Table er pichoner right leg --------------------
-        model = transforamtion(22.2, 0.0, 1.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // ----------------Table er uporar part--------------------
-        model = transforamtion(19.5, .9, 0.2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 6, .1, 3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        /*//////////////////////////////////////////////////////////////////////////////////////////*/
-
-        //------------Font wallmat---------------------- 
-        model = transforamtion(1.075, 1.65, 0.075, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 2.2, 4.4, .05);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-
-
-        // ----------------wallmat left--------------------
-        model = transforamtion(1, 1.5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 2.5, 5,.15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-
-        //------------------------------------------********************************------------------------------------
-        // ----------------Fan--------------------
-        // ----------------Fan er uporer part---------------
-        model = transforamtion(5, 5, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, -.2, 1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        // ----------------Fan er hanger--------------------
-        model = transforamtion(5.2125, 4.9, 5.2125, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .15, -1, .15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        // ----------------Fan er nicher part-----------------
-        model = transforamtion(5, 4.4, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, -.33, 1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        /**********************Room3 Left**********************/
-        model = transforamtion(10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, -10);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(10, 0, -5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 10, 0.15);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(22.5, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, -10);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOW1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        //------------------Floor3 for room2------------------
-        model = transforamtion(10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, -10);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAODD);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        ////--------------Roof for room3----------------------
-        model = transforamtion(10, 5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, -10);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOT);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        // ----------------Table er uporar part room3--------------------
-        model = transforamtion(17, 1, -4.9, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .4, 3.2);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(15, 1.2, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(15.5, 1.2, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 0.7, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOC);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(15, 4.7, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 8, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(14.89, 4.7, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        model = transforamtion(19, 4.7, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOTV);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
+    //------------------------paposh-----------------------
+    scene.addNode(cubeMesh, matC, 5.8, 0, 2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -8, 0.2, 8);
 
-        // ----------------Fan gurar Condation----------------
-        Fan fan;
-        ourShader = fan.local_rotation(ourShader, VAOF3, i);
 
-        if (fan_turn)
-            i -= 1;
-        if (rotate_around)
-           camera.ProcessKeyboard(Y_LEFT, deltaTime);
-        //nicher 
-        model = transforamtion(5, 4.225, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, -.05, 1);
-        ourShader.setMat4("model", model);
-        glBindVertexArray(VAOF1);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    //********************--Lamp--*******************
+    scene.instantiate(floorLamp, 8.5, 0, 3.5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
+    /*--------------Room2 Lamp-----------------*/
+    scene.instantiate(tableLamp, 21, 1, .5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
-    // --------------------****************************************************------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    
-    glDeleteVertexArrays(1, &VAOCA);
-    glDeleteBuffers(1, &VBOCA);
-    glDeleteBuffers(1, &EBOCA);
-
-    glDeleteVertexArrays(1, &VAOT);
-    glDeleteBuffers(1, &VBOT);
-    glDeleteBuffers(1, &EBOT);
-
-    glDeleteVertexArrays(1, &VAOG);
-    glDeleteBuffers(1, &VBOG);
-    glDeleteBuffers(1, &EBOG);
-
-    glDeleteVertexArrays(1, &VAOW);
-    glDeleteBuffers(1, &VBOW);
-    glDeleteBuffers(1, &EBOW);
-
-    glDeleteVertexArrays(1, &VAOW1);
-    glDeleteBuffers(1, &VBOW1);
-    glDeleteBuffers(1, &EBOW1);
-
-    glDeleteVertexArrays(1, &VAOC);
-    glDeleteBuffers(1, &VBOC);
-    glDeleteBuffers(1, &EBOC);
-
-    glDeleteVertexArrays(1, &VAOC2);
-    glDeleteBuffers(1, &VBOC2);
-    glDeleteBuffers(1, &EBOC2);
-
-    glDeleteVertexArrays(1, &VAOTV);
-    glDeleteBuffers(1, &VBOTV);
-    glDeleteBuffers(1, &EBOTV);
-    /************************************/
-    glDeleteVertexArrays(1, &VAOQ);
-    glDeleteBuffers(1, &VBOQ);
-    glDeleteBuffers(1, &EBOQ);
-
-    glDeleteVertexArrays(1, &VAOWY);
-    glDeleteBuffers(1, &VBOWY);
-    glDeleteBuffers(1, &EBOWY);
-
-    glDeleteVertexArrays(1, &VAODD);
-    glDeleteBuffers(1, &VBODD);
-    glDeleteBuffers(1, &EBODD);
-
-    glDeleteVertexArrays(1, &VAOAC);
-    glDeleteBuffers(1, &VBOAC);
-    glDeleteBuffers(1, &EBOAC);
-    // -------------------------------
 
-    glfwTerminate();
-    return 0;
+
+    //-------------sofa 2-----------------
+    scene.instantiate(longSofa, 6.6, 0, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
+
+    //*******************window*********************
+    //----------------------pordar hanger--------------------------
+    scene.addNode(cubeMesh, matF2, 2.65, 4, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 8.4, 1, -.5);
+
+    // -----------------window porson glass black--------------
+    scene.addNode(cubeMesh, matTV, 3, 1.5, 10, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 7, 5, -.15);
+    /*--------------ROOM2 ----------------*/
+     //----------------------pordar hanger--------------------------
+    scene.addNode(cubeMesh, matF2, 15.65, 4, 0.3, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 8.4, 1, -.5);
+
+    // -----------------window porson glass black--------------
+    scene.addNode(cubeMesh, matTV, 16, 1.5, 0.1, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 7, 5, -.15);
+    /*--------------------------------------------------*/
+
+    // ----------------**Table**--------------------
+    scene.instantiate(diningTable, 5.8, 0, 6.2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
+
+    // ----------------**Room 2 Table**--------------------
+    scene.instantiate(table, 19.5, 0, .2, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
+    /*//////////////////////////////////////////////////////////////////////////////////////////*/
+
+    //------------Font wallmat----------------------
+    scene.addNode(cubeMesh, matC, 1.075, 1.65, 0.075, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 2.2, 4.4, .05);
+
+
+
+    // ----------------wallmat left--------------------
+    scene.addNode(cubeMesh, matTV, 1, 1.5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 2.5, 5,.15);
+
+
+    //------------------------------------------********************************------------------------------------
+    // ----------------Fan--------------------
+    int fanBody = scene.instantiate(fan, 5, 5, 5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 1, 1);
+
+    /**********************Room3 Left**********************/
+    scene.addNode(cubeMesh, matW1, 10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, -10);
+
+    scene.addNode(cubeMesh, matW1, 10, 0, -5, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 10, 0.15);
+
+    scene.addNode(cubeMesh, matW1, 22.5, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 0.1, 10, -10);
+    //------------------Floor3 for room2------------------
+    scene.addNode(cubeMesh, matDD, 10, 0, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, -10);
+
+    ////--------------Roof for room3----------------------
+    scene.addNode(cubeMesh, matT, 10, 5, 0, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 25, 0.1, -10);
+    // ----------------Table er uporar part room3--------------------
+    scene.addNode(cubeMesh, matF1, 17, 1, -4.9, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, -6.2, .4, 3.2);
+
+    scene.addNode(cubeMesh, matTV, 15, 1.2, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
+
+    scene.addNode(cubeMesh, matC, 15.5, 1.2, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 1, 0.7, -.3);
+
+    scene.addNode(cubeMesh, matF1, 15, 4.7, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, 8, 1.2, -.3);
+
+    scene.addNode(cubeMesh, matTV, 14.89, 4.7, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
+
+    scene.addNode(cubeMesh, matTV, 19, 4.7, -4.7, rotateAngle_X, rotateAngle_Y, rotateAngle_Z, .3, 1.2, -.3);
+
+
+    // blades of the ceiling fan, animated by the Fan rig, turning about the centre
+    // of the body's lowest part
+    scene.addFan(fanBody, glm::vec3(0.25f, -0.75f, 0.25f), cubeMesh, matF3);
+
+    //------------------Lights------------------
+    // daylight through the open side, then the lamps, the light under the fan and
+    // one ceiling light in each of the other rooms
+    scene.addLight(LIGHT_DIRECTIONAL, glm::vec3(0.0f), glm::vec3(0.4f, -1.0f, 0.3f), glm::vec3(0.45f, 0.45f, 0.42f), 0.0f);
+    scene.addLight(LIGHT_POINT, glm::vec3(8.8f, 1.6f, 3.8f), glm::vec3(0.0f), glm::vec3(4.0f, 3.2f, 2.0f), 7.0f);
+    scene.addLight(LIGHT_SPOT, glm::vec3(21.3f, 1.7f, 0.8f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(5.0f, 4.2f, 2.8f), 5.0f, 25.0f, 45.0f);
+    scene.addLight(LIGHT_POINT, glm::vec3(5.25f, 3.4f, 5.25f), glm::vec3(0.0f), glm::vec3(5.0f, 5.0f, 4.7f), 8.0f);
+    scene.addLight(LIGHT_POINT, glm::vec3(16.0f, 4.6f, 5.0f), glm::vec3(0.0f), glm::vec3(10.0f, 10.0f, 9.5f), 8.0f);
+    scene.addLight(LIGHT_POINT, glm::vec3(16.0f, 4.6f, -2.5f), glm::vec3(0.0f), glm::vec3(8.0f, 8.0f, 7.5f), 7.0f);
+
+    //------------------Rooms and doors------------------
+    int diningRoom = scene.addRoom("dining room", glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(10.0f, 5.0f, 10.0f));
+    int bedroom = scene.addRoom("bedroom", glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(22.5f, 5.0f, 10.0f));
+    int room3 = scene.addRoom("room3", glm::vec3(10.0f, 0.0f, -5.0f), glm::vec3(22.5f, 5.0f, 0.0f));
+    // open side of the dining room
+    scene.addPortal(-1, diningRoom, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 5.0f, 10.0f));
+    // DOOR in "door er sather Wall2"
+    scene.addPortal(diningRoom, bedroom, glm::vec3(10.0f, 0.0f, 0.075f), glm::vec3(10.0f, 3.355f, 2.1f));
+    // 2nd door, under "2nd door er uporar part"
+    scene.addPortal(bedroom, room3, glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(11.45f, 3.34f, 0.0f));
+}
+
+// keyboard camera movement, also captured for --record
+// ------------------------------------
+void moveCamera(Camera_Movement direction)
+{
+    camera.ProcessKeyboard(direction, deltaTime);
+    frameInput.movement |= 1u << direction;
 }
 
 // ------------------------------------
@@ -1647,41 +1210,41 @@ void processInput(GLFWwindow* window)
         glfwSetWindowShouldClose(window, true);
 
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-        camera.ProcessKeyboard(FORWARD, deltaTime);
+        moveCamera(FORWARD);
     }
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
+        moveCamera(BACKWARD);
     }
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-        camera.ProcessKeyboard(LEFT, deltaTime);
+        moveCamera(LEFT);
     }
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-        camera.ProcessKeyboard(RIGHT, deltaTime);
+        moveCamera(RIGHT);
     }
 
     if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) {
-        camera.ProcessKeyboard(UP, deltaTime);
+        moveCamera(UP);
     }
     if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
-        camera.ProcessKeyboard(DOWN, deltaTime);
+        moveCamera(DOWN);
     }
     if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS) {
-        camera.ProcessKeyboard(P_UP, deltaTime);
+        moveCamera(P_UP);
     }
     if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS) {
-        camera.ProcessKeyboard(P_DOWN, deltaTime);
+        moveCamera(P_DOWN);
     }
     if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS) {
-        camera.ProcessKeyboard(Y_LEFT, deltaTime);
+        moveCamera(Y_LEFT);
     }
     if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS) {
-        camera.ProcessKeyboard(Y_RIGHT, deltaTime);
+        moveCamera(Y_RIGHT);
     }
     if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS) {
-        camera.ProcessKeyboard(R_LEFT, deltaTime);
+        moveCamera(R_LEFT);
     }
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
-        camera.ProcessKeyboard(R_RIGHT, deltaTime);
+        moveCamera(R_RIGHT);
     }
     if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS) {
         if (!fan_turn) {
@@ -1691,6 +1254,9 @@ void processInput(GLFWwindow* window)
             fan_turn = false;
         }
     }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS) {
+        show_timing = !show_timing;
+    }
     if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
         if (!rotate_around) {
             rotate_around = true;
@@ -1706,6 +1272,8 @@ void processInput(GLFWwindow* window)
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
+    viewportWidth = width;
+    viewportHeight = height;
     glViewport(0, 0, width, height);
 }
 
@@ -1732,6 +1300,8 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
     lastY = ypos;
 
     camera.ProcessMouseMovement(xoffset, yoffset);
+    frameInput.mouseX += xoffset;
+    frameInput.mouseY += yoffset;
 }
 
 //mouse scroll wheel scrolls
@@ -0,0 +1,478 @@
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include "render_stats.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// All meshes share one VBO, one EBO and one VAO. A mesh is a range of the index
+// buffer plus the base vertex its indices are relative to, so a draw never needs
+// anything but glDrawElementsBaseVertex and the single VAO bind. Draws pass
+// indexType and offset by indexSize().
+class MeshArena
+{
+public:
+    // floats of one vertex: position, normal, colour
+    static const int VERTEX_FLOATS = 9;
+
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    std::vector<float> vertices;            // VERTEX_FLOATS per vertex
+    std::vector<unsigned int> indices;
+    size_t vertexCount = 0, indexCount = 0;     // what the GL buffers hold
+    size_t vertexCapacity = 0, indexCapacity = 0;   // what they have room for
+    // Pack the GL copies where they fit: half-float positions, 10-bit normals and
+    // byte colours (16 bytes a vertex instead of 36) and 16-bit indices. The CPU copies stay
+    // float and 32-bit; the format is picked at upload.
+    bool pack = true;
+    bool packedVertices = false;
+    GLenum indexType = GL_UNSIGNED_INT;
+
+    // half-float position padded to 8 bytes, normal as signed normalised 10-bit
+    // x, y, z (GL_INT_2_10_10_10_REV), colour as normalised bytes
+    struct PackedVertex
+    {
+        uint16_t position[4];
+        uint32_t normal;
+        uint8_t color[4];
+    };
+
+    // append interleaved position/colour vertices (6 floats each), returns their
+    // base vertex; the normals stay zero until computeNormals()
+    // ------------------------------------------------------------------------
+    GLint addVertices(const float* data, int vertexCount)
+    {
+        GLint baseVertex = (GLint)(vertices.size() / VERTEX_FLOATS);
+        for (int v = 0; v < vertexCount; v++)
+        {
+            const float* source = data + v * 6;
+            const float vertex[VERTEX_FLOATS] = { source[0], source[1], source[2], 0.0f, 0.0f, 0.0f, source[3], source[4], source[5] };
+            vertices.insert(vertices.end(), vertex, vertex + VERTEX_FLOATS);
+        }
+        return baseVertex;
+    }
+
+    // append indices relative to a base vertex, returns the first index
+    // ------------------------------------------------------------------------
+    GLuint addIndices(const unsigned int* data, int count)
+    {
+        GLuint firstIndex = (GLuint)indices.size();
+        indices.insert(indices.end(), data, data + count);
+        return firstIndex;
+    }
+
+    // room for vertexCount vertices and count indices written in place by a mesh
+    // generator; the pointers are valid until the next add or allocate
+    // ------------------------------------------------------------------------
+    float* allocateVertices(int vertexCount, GLint& baseVertex)
+    {
+        baseVertex = (GLint)(vertices.size() / VERTEX_FLOATS);
+        vertices.resize(vertices.size() + (size_t)vertexCount * VERTEX_FLOATS);
+        return &vertices[(size_t)baseVertex * VERTEX_FLOATS];
+    }
+
+    unsigned int* allocateIndices(int count, GLuint& firstIndex)
+    {
+        firstIndex = (GLuint)indices.size();
+        indices.resize(indices.size() + count);
+        return &indices[firstIndex];
+    }
+
+    // smooth normals of a triangle list: every vertex gets the area-weighted sum of
+    // the face normals around it, faces wound counter-clockwise seen from outside.
+    // Vertices are shared only where the mesh shares them, so a cube with a
+    // vertex per face corner stays flat.
+    // ------------------------------------------------------------------------
+    void computeNormals(GLenum mode, GLuint firstIndex, GLsizei count, GLint baseVertex)
+    {
+        if (mode != GL_TRIANGLES)
+            return;
+        for (GLsizei i = 0; i < count; i++)
+        {
+            float* normal = &vertices[(size_t)(baseVertex + indices[firstIndex + i]) * VERTEX_FLOATS + 3];
+            normal[0] = normal[1] = normal[2] = 0.0f;
+        }
+        for (GLsizei i = 0; i + 2 < count; i += 3)
+        {
+            float* corners[3];
+            for (int c = 0; c < 3; c++)
+                corners[c] = &vertices[(size_t)(baseVertex + indices[firstIndex + i + c]) * VERTEX_FLOATS];
+            glm::vec3 a(corners[0][0], corners[0][1], corners[0][2]);
+            glm::vec3 b(corners[1][0], corners[1][1], corners[1][2]);
+            glm::vec3 c(corners[2][0], corners[2][1], corners[2][2]);
+            glm::vec3 face = glm::cross(b - a, c - a);
+            for (float* corner : corners)
+            {
+                corner[3] += face.x;
+                corner[4] += face.y;
+                corner[5] += face.z;
+            }
+        }
+        for (GLsizei i = 0; i < count; i++)
+        {
+            float* normal = &vertices[(size_t)(baseVertex + indices[firstIndex + i]) * VERTEX_FLOATS + 3];
+            float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length > 0.0f && length != 1.0f)
+            {
+                normal[0] /= length;
+                normal[1] /= length;
+                normal[2] /= length;
+            }
+        }
+    }
+
+    // object-space box around the vertices referenced by an index range
+    // ------------------------------------------------------------------------
+    void bounds(GLuint firstIndex, GLsizei count, GLint baseVertex, glm::vec3& boundsMin, glm::vec3& boundsMax) const
+    {
+        boundsMin = glm::vec3(1e30f);
+        boundsMax = glm::vec3(-1e30f);
+        for (GLsizei i = 0; i < count; i++)
+        {
+            const float* p = &vertices[(size_t)(baseVertex + indices[firstIndex + i]) * VERTEX_FLOATS];
+            glm::vec3 position(p[0], p[1], p[2]);
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+    }
+
+    // create the GL objects once every mesh has been added
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        upload(vertices.data(), vertices.size() / VERTEX_FLOATS, indices.data(), indices.size());
+    }
+
+    // create the GL objects straight from external memory (a mapped scene file);
+    // the CPU copies stay empty
+    // ------------------------------------------------------------------------
+    void upload(const float* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount)
+    {
+        this->vertexCount = vertexCapacity = vertexCount;
+        this->indexCount = indexCapacity = indexCount;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        bufferVertices(vertexData, vertexCount);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        bufferIndices(indexData, indexCount);
+    }
+
+    // create the GL objects from geometry already in the GL layout (the packed
+    // sections of a mapped scene file): PackedVertex or VERTEX_FLOATS floats per
+    // vertex, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT indices. Nothing is converted.
+    // ------------------------------------------------------------------------
+    void uploadLayout(const void* vertexData, size_t vertexCount, bool packed, const void* indexData, size_t indexCount, GLenum type)
+    {
+        this->vertexCount = vertexCapacity = vertexCount;
+        this->indexCount = indexCapacity = indexCount;
+        packedVertices = packed;
+        indexType = type;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * vertexSize(), vertexData, GL_STATIC_DRAW);
+        pointAttributes();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize(), indexData, GL_STATIC_DRAW);
+    }
+
+    // the packed GL layout of float vertices and 32-bit indices, for uploadLayout();
+    // each output stays empty where the data does not fit, whatever `pack` says
+    // ------------------------------------------------------------------------
+    static void packLayout(const float* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount,
+        std::vector<PackedVertex>& packed, std::vector<uint16_t>& shortIndices)
+    {
+        packed.clear();
+        shortIndices.clear();
+        if (fitsPacked(vertexData, vertexCount))
+        {
+            packed.resize(vertexCount);
+            packVertices(vertexData, 0, vertexCount, packed.data());
+        }
+        if (fitsShort(indexData, indexCount))
+            shortIndices.assign(indexData, indexData + indexCount);
+    }
+
+    // Replace the geometry with new CPU copies and send only the spans that differ
+    // from the current ones; a buffer is reallocated only when it has to grow or
+    // its format changes. Needs the CPU copies of the current geometry. Returns the
+    // bytes uploaded.
+    // ------------------------------------------------------------------------
+    size_t update(const std::vector<float>& newVertices, const std::vector<unsigned int>& newIndices)
+    {
+        glBindVertexArray(VAO);
+        size_t bytes = 0;
+        size_t newVertexCount = newVertices.size() / VERTEX_FLOATS;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        if (newVertexCount > vertexCapacity || packable(newVertices.data(), newVertexCount) != packedVertices)
+        {
+            bytes += bufferVertices(newVertices.data(), newVertexCount);
+            vertexCapacity = newVertexCount;
+        }
+        else
+        {
+            bytes += uploadChanges(vertices, newVertices, VERTEX_FLOATS, [&](size_t first, size_t end) {
+                return writeVertices(newVertices.data(), first, end);
+            });
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        if (newIndices.size() > indexCapacity || shortIndexable(newIndices.data(), newIndices.size()) != (indexType == GL_UNSIGNED_SHORT))
+        {
+            bytes += bufferIndices(newIndices.data(), newIndices.size());
+            indexCapacity = newIndices.size();
+        }
+        else
+        {
+            bytes += uploadChanges(indices, newIndices, 1, [&](size_t first, size_t end) {
+                return writeIndices(newIndices.data(), first, end);
+            });
+        }
+        vertices = newVertices;
+        indices = newIndices;
+        vertexCount = vertices.size() / VERTEX_FLOATS;
+        indexCount = indices.size();
+        return bytes;
+    }
+
+    // bytes of one vertex and one index in the GL buffers
+    size_t vertexSize() const
+    {
+        return packedVertices ? sizeof(PackedVertex) : VERTEX_FLOATS * sizeof(float);
+    }
+
+    size_t indexSize() const
+    {
+        return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+    }
+
+    size_t gpuBytes() const
+    {
+        return vertexCount * vertexSize() + indexCount * indexSize();
+    }
+
+    void bind() const
+    {
+        glBindVertexArray(VAO);
+        countStateChange();
+    }
+
+    void release()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+
+private:
+    // runs of differing elements closer than this are sent as one glBufferSubData
+    static const size_t MERGE_GAP = 64;
+    // positions stay float past this magnitude, where half floats get coarser than
+    // 1/128 of a unit
+    static constexpr float HALF_POSITION_LIMIT = 16.0f;
+
+    std::vector<PackedVertex> packScratch;
+    std::vector<uint16_t> indexScratch;
+
+    // round to nearest even; packable() keeps the values in the normal range
+    static uint16_t toHalf(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFF;
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return (uint16_t)sign;
+            // subnormal half
+            mantissa |= 0x800000;
+            int shift = 14 - exponent;
+            uint32_t half = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1)))
+                half++;
+            return (uint16_t)(sign | half);
+        }
+        uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+        uint32_t rest = mantissa & 0x1FFF;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+            half++;     // a carry into the exponent is still the right value
+        return (uint16_t)(sign | half);
+    }
+
+    bool packable(const float* data, size_t count) const
+    {
+        return pack && fitsPacked(data, count);
+    }
+
+    static bool fitsPacked(const float* data, size_t count)
+    {
+        for (size_t v = 0; v < count; v++)
+        {
+            const float* vertex = data + v * VERTEX_FLOATS;
+            for (int c = 0; c < 3; c++)
+            {
+                if (!(std::fabs(vertex[c]) <= HALF_POSITION_LIMIT) || !(vertex[6 + c] >= 0.0f && vertex[6 + c] <= 1.0f))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool shortIndexable(const unsigned int* data, size_t count) const
+    {
+        return pack && fitsShort(data, count);
+    }
+
+    static bool fitsShort(const unsigned int* data, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            if (data[i] > 0xFFFF)
+                return false;
+        return true;
+    }
+
+    // (re)allocate the vertex buffer in the format the data fits and point the
+    // attributes at it; needs the VAO and VBO bound
+    size_t bufferVertices(const float* data, size_t count)
+    {
+        packedVertices = packable(data, count);
+        if (packedVertices)
+        {
+            packScratch.resize(count);
+            packVertices(data, 0, count, packScratch.data());
+            glBufferData(GL_ARRAY_BUFFER, count * sizeof(PackedVertex), packScratch.data(), GL_STATIC_DRAW);
+        }
+        else
+            glBufferData(GL_ARRAY_BUFFER, count * VERTEX_FLOATS * sizeof(float), data, GL_STATIC_DRAW);
+        pointAttributes();
+        return count * vertexSize();
+    }
+
+    // vertex attributes of the current format; needs the VAO and VBO bound
+    void pointAttributes()
+    {
+        if (packedVertices)
+        {
+            glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)0);
+            glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, color));
+            glVertexAttribPointer(11, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+        }
+        else
+        {
+            // position attribute
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+            //color attribute
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)24);
+            // normal attribute
+            glVertexAttribPointer(11, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)12);
+        }
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(11);
+    }
+
+    size_t bufferIndices(const unsigned int* data, size_t count)
+    {
+        indexType = shortIndexable(data, count) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        if (indexType == GL_UNSIGNED_SHORT)
+        {
+            indexScratch.assign(data, data + count);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint16_t), indexScratch.data(), GL_STATIC_DRAW);
+        }
+        else
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+        return count * indexSize();
+    }
+
+    static void packVertices(const float* data, size_t first, size_t end, PackedVertex* out)
+    {
+        for (size_t v = first; v < end; v++)
+        {
+            const float* source = data + v * VERTEX_FLOATS;
+            PackedVertex& packed = out[v - first];
+            packed.normal = 0;
+            for (int c = 0; c < 3; c++)
+            {
+                packed.position[c] = toHalf(source[c]);
+                float n = std::min(std::max(source[3 + c], -1.0f), 1.0f);
+                packed.normal |= ((uint32_t)(int32_t)std::lround(n * 511.0f) & 0x3FF) << (10 * c);
+                packed.color[c] = (uint8_t)(source[6 + c] * 255.0f + 0.5f);
+            }
+            packed.position[3] = 0;
+            packed.color[3] = 255;
+        }
+    }
+
+    // vertices [first, end) into the current buffer
+    size_t writeVertices(const float* data, size_t first, size_t end)
+    {
+        if (!packedVertices)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, first * VERTEX_FLOATS * sizeof(float), (end - first) * VERTEX_FLOATS * sizeof(float),
+                data + first * VERTEX_FLOATS);
+            return (end - first) * VERTEX_FLOATS * sizeof(float);
+        }
+        packScratch.resize(end - first);
+        packVertices(data, first, end, packScratch.data());
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(PackedVertex), (end - first) * sizeof(PackedVertex), packScratch.data());
+        return (end - first) * sizeof(PackedVertex);
+    }
+
+    size_t writeIndices(const unsigned int* data, size_t first, size_t end)
+    {
+        if (indexType == GL_UNSIGNED_INT)
+        {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(unsigned int), (end - first) * sizeof(unsigned int), data + first);
+            return (end - first) * sizeof(unsigned int);
+        }
+        indexScratch.assign(data + first, data + end);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(uint16_t), (end - first) * sizeof(uint16_t), indexScratch.data());
+        return (end - first) * sizeof(uint16_t);
+    }
+
+    // find the runs of rows (stride elements each) that differ between current and
+    // next and hand each to write(first, end)
+    template <typename T, typename Write>
+    static size_t uploadChanges(const std::vector<T>& current, const std::vector<T>& next, size_t stride, Write write)
+    {
+        size_t bytes = 0;
+        size_t i = 0;
+        while (i < next.size())
+        {
+            if (i < current.size() && current[i] == next[i])
+            {
+                i++;
+                continue;
+            }
+            size_t first = i, last = i, equal = 0;
+            for (i++; i < next.size() && equal < MERGE_GAP; i++)
+            {
+                if (i < current.size() && current[i] == next[i])
+                    equal++;
+                else
+                {
+                    last = i;
+                    equal = 0;
+                }
+            }
+            i = last + 1;
+            bytes += write(first / stride, last / stride + 1);
+        }
+        return bytes;
+    }
+};
+
+#endif
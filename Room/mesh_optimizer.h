@@ -0,0 +1,339 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include "scene_graph.h"
+#include "mesh_arena.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// vertex and index counts, and post-transform cache misses, before and after
+// optimizeMeshes()
+struct MeshOptimizationReport
+{
+    size_t verticesBefore = 0, verticesAfter = 0;
+    size_t indicesBefore = 0, indicesAfter = 0;
+    size_t triangles = 0;                   // in the triangle lists measured
+    size_t missesBefore = 0, missesAfter = 0;
+    double milliseconds = 0.0;
+
+    // average cache misses per triangle: 3 is no reuse at all, 0.5 the ideal for
+    // a large regular grid
+    float acmrBefore() const { return triangles ? (float)missesBefore / triangles : 0.0f; }
+    float acmrAfter() const { return triangles ? (float)missesAfter / triangles : 0.0f; }
+};
+
+// Load-time clean-up of the arena once every mesh has been added:
+//
+//  - weld: vertices of a mesh with the same position, normal and colour become one.
+//    The built-in meshes have no such duplicates once computeNormals() gives every
+//    face its own normals, so this only merges repeats in inline scene meshes
+//  - reorder: triangle lists are reordered for the post-transform vertex cache
+//    with Forsyth's linear-speed optimizer, then the vertices are renumbered in
+//    the order the triangles first use them, so fetches walk the buffer forward
+//
+// Each distinct input range (mode, indices and base vertex) is rebuilt once. A
+// rebuilt index list equal to an earlier one is not stored again, the mesh draws
+// the earlier indices from its own base vertex, so meshes that shared an index
+// range at different base vertices still share one; equal vertices are shared the
+// same way. Lines and strips are welded but keep their order. Vertices no mesh
+// references are dropped.
+namespace mesh_optimizer_detail
+{
+    // entries of the FIFO cache the ACMR is measured with
+    const size_t FIFO_SIZE = 16;
+    // entries of the LRU cache the reorder scores against
+    const int SCORE_CACHE_SIZE = 32;
+
+    struct VertexKey
+    {
+        float data[MeshArena::VERTEX_FLOATS];
+
+        bool operator==(const VertexKey& other) const
+        {
+            return memcmp(data, other.data, sizeof(data)) == 0;
+        }
+    };
+
+    struct VertexKeyHash
+    {
+        size_t operator()(const VertexKey& key) const
+        {
+            uint32_t words[MeshArena::VERTEX_FLOATS];
+            memcpy(words, key.data, sizeof(words));
+            uint64_t hash = 14695981039346656037ull;
+            for (uint32_t word : words)
+                hash = (hash ^ word) * 1099511628211ull;
+            return (size_t)hash;
+        }
+    };
+
+    // misses of a FIFO cache of FIFO_SIZE entries over a triangle list
+    inline size_t fifoMisses(const unsigned int* indices, size_t count, size_t vertexCount)
+    {
+        std::vector<size_t> inserted(vertexCount, (size_t)-1);
+        size_t misses = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t& when = inserted[indices[i]];
+            if (when == (size_t)-1 || misses - when >= FIFO_SIZE)
+                when = misses++;
+        }
+        return misses;
+    }
+
+    inline float vertexScore(int cachePosition, unsigned int valence)
+    {
+        if (valence == 0)
+            return -1.0f;
+        float score = 0.0f;
+        // the last triangle's vertices score the same whatever their order
+        if (cachePosition >= 0 && cachePosition < 3)
+            score = 0.75f;
+        else if (cachePosition >= 3)
+            score = std::pow(1.0f - (float)(cachePosition - 3) / (SCORE_CACHE_SIZE - 3), 1.5f);
+        // vertices with few triangles left are worth finishing off
+        return score + 2.0f / std::sqrt((float)valence);
+    }
+
+    // Forsyth's greedy reorder: emit the highest-scoring triangle touching the
+    // cache, move its vertices to the front, rescore what the cache holds
+    inline void reorderTriangles(std::vector<unsigned int>& indices, size_t vertexCount)
+    {
+        size_t triangleCount = indices.size() / 3;
+        std::vector<unsigned int> valence(vertexCount, 0), offsets(vertexCount + 1, 0);
+        for (unsigned int v : indices)
+            valence[v]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] = offsets[v] + valence[v];
+        // the live triangles of every vertex, at the front of its slice
+        std::vector<unsigned int> adjacency(indices.size()), live(vertexCount, 0);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            unsigned int v = indices[i];
+            adjacency[offsets[v] + live[v]++] = (unsigned int)(i / 3);
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> score(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            score[v] = vertexScore(-1, live[v]);
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<char> emitted(triangleCount, 0);
+        for (size_t t = 0; t < triangleCount; t++)
+            triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+
+        std::vector<unsigned int> order, cache, next;
+        order.reserve(indices.size());
+        size_t cursor = 0;
+        int best = -1;
+        while (order.size() < indices.size())
+        {
+            if (best < 0)
+            {
+                // nothing in the cache has triangles left, start anywhere
+                while (emitted[cursor])
+                    cursor++;
+                best = (int)cursor;
+            }
+            emitted[best] = 1;
+            next.clear();
+            for (int corner = 0; corner < 3; corner++)
+            {
+                unsigned int v = indices[best * 3 + corner];
+                order.push_back(v);
+                unsigned int* triangles = &adjacency[offsets[v]];
+                for (unsigned int i = 0; i < live[v]; i++)
+                {
+                    if (triangles[i] == (unsigned int)best)
+                    {
+                        triangles[i] = triangles[--live[v]];
+                        break;
+                    }
+                }
+                if (std::find(next.begin(), next.end(), v) == next.end())
+                    next.push_back(v);
+            }
+            for (unsigned int v : cache)
+                if (std::find(next.begin(), next.end(), v) == next.end())
+                    next.push_back(v);
+
+            // rescore every vertex that is or was in the cache; entries pushed past
+            // the end drop out
+            for (size_t i = 0; i < next.size(); i++)
+            {
+                unsigned int v = next[i];
+                cachePosition[v] = i < (size_t)SCORE_CACHE_SIZE ? (int)i : -1;
+                float updated = vertexScore(cachePosition[v], live[v]);
+                float delta = updated - score[v];
+                score[v] = updated;
+                for (unsigned int a = 0; a < live[v]; a++)
+                    triangleScore[adjacency[offsets[v] + a]] += delta;
+            }
+            if (next.size() > (size_t)SCORE_CACHE_SIZE)
+                next.resize(SCORE_CACHE_SIZE);
+            cache.swap(next);
+
+            best = -1;
+            float bestScore = -1e30f;
+            for (unsigned int v : cache)
+            {
+                for (unsigned int a = 0; a < live[v]; a++)
+                {
+                    unsigned int t = adjacency[offsets[v] + a];
+                    if (triangleScore[t] > bestScore)
+                    {
+                        bestScore = triangleScore[t];
+                        best = (int)t;
+                    }
+                }
+            }
+        }
+        indices.swap(order);
+    }
+
+    struct RangeKey
+    {
+        GLenum mode;
+        GLsizei count;
+        GLuint firstIndex;
+        GLint baseVertex;
+    };
+
+    // an index list or vertex block already in the output
+    struct Output
+    {
+        size_t first, count;
+    };
+
+    // the earlier output holding exactly data[0, count), or -1
+    template <typename T>
+    inline long findOutput(const std::vector<Output>& outputs, const std::vector<T>& stored, const T* data, size_t count)
+    {
+        for (size_t o = 0; o < outputs.size(); o++)
+            if (outputs[o].count == count && memcmp(&stored[outputs[o].first], data, count * sizeof(T)) == 0)
+                return (long)o;
+        return -1;
+    }
+}
+
+// ------------------------------------------------------------------------
+inline MeshOptimizationReport optimizeMeshes(SceneGraph& scene, MeshArena& arena)
+{
+    using namespace mesh_optimizer_detail;
+
+    auto start = std::chrono::steady_clock::now();
+    MeshOptimizationReport report;
+    report.verticesBefore = arena.vertices.size() / MeshArena::VERTEX_FLOATS;
+    report.indicesBefore = arena.indices.size();
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<RangeKey> ranges;           // ranges rebuilt so far
+    std::vector<GLuint> rangeFirst;         // and where they went
+    std::vector<GLint> rangeBase;
+    std::vector<Output> indexOutputs, vertexOutputs;
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> welded;
+    std::vector<unsigned int> local, firstUse;
+    std::vector<float> localVertices, ordered;
+
+    for (Mesh& mesh : scene.meshes)
+    {
+        size_t r = 0;
+        while (r < ranges.size() && !(ranges[r].mode == mesh.mode && ranges[r].count == mesh.count &&
+            ranges[r].firstIndex == mesh.firstIndex && ranges[r].baseVertex == mesh.baseVertex))
+            r++;
+        if (r == ranges.size())
+        {
+            // weld the vertices the range references into a local numbering
+            welded.clear();
+            local.resize(mesh.count);
+            localVertices.clear();
+            unsigned int originalMax = 0;
+            for (GLsizei i = 0; i < mesh.count; i++)
+            {
+                unsigned int original = arena.indices[mesh.firstIndex + i];
+                originalMax = original > originalMax ? original : originalMax;
+                VertexKey key;
+                memcpy(key.data, &arena.vertices[(size_t)(mesh.baseVertex + original) * MeshArena::VERTEX_FLOATS], sizeof(key.data));
+                auto found = welded.emplace(key, (unsigned int)welded.size());
+                if (found.second)
+                    localVertices.insert(localVertices.end(), key.data, key.data + MeshArena::VERTEX_FLOATS);
+                local[i] = found.first->second;
+            }
+            size_t vertexCount = welded.size();
+
+            bool triangles = mesh.mode == GL_TRIANGLES && mesh.count % 3 == 0;
+            if (triangles)
+            {
+                report.triangles += mesh.count / 3;
+                report.missesBefore += fifoMisses(&arena.indices[mesh.firstIndex], mesh.count, (size_t)originalMax + 1);
+                reorderTriangles(local, vertexCount);
+            }
+
+            // renumber in order of first use
+            firstUse.assign(vertexCount, ~0u);
+            ordered.clear();
+            unsigned int used = 0;
+            for (unsigned int& v : local)
+            {
+                if (firstUse[v] == ~0u)
+                {
+                    firstUse[v] = used++;
+                    const float* vertex = &localVertices[(size_t)v * MeshArena::VERTEX_FLOATS];
+                    ordered.insert(ordered.end(), vertex, vertex + MeshArena::VERTEX_FLOATS);
+                }
+                v = firstUse[v];
+            }
+            if (triangles)
+                report.missesAfter += fifoMisses(local.data(), mesh.count, vertexCount);
+
+            // store the indices and the vertices unless an earlier mesh came out the same
+            long sameIndices = findOutput(indexOutputs, indices, local.data(), local.size());
+            GLuint firstIndex = (GLuint)(sameIndices < 0 ? indices.size() : indexOutputs[sameIndices].first);
+            if (sameIndices < 0)
+            {
+                indexOutputs.push_back({ indices.size(), local.size() });
+                indices.insert(indices.end(), local.begin(), local.end());
+            }
+            long sameVertices = findOutput(vertexOutputs, vertices, ordered.data(), ordered.size());
+            size_t vertexFloat = sameVertices < 0 ? vertices.size() : vertexOutputs[sameVertices].first;
+            if (sameVertices < 0)
+            {
+                vertexOutputs.push_back({ vertices.size(), ordered.size() });
+                vertices.insert(vertices.end(), ordered.begin(), ordered.end());
+            }
+            GLint baseVertex = (GLint)(vertexFloat / MeshArena::VERTEX_FLOATS);
+
+            ranges.push_back({ mesh.mode, mesh.count, mesh.firstIndex, mesh.baseVertex });
+            rangeFirst.push_back(firstIndex);
+            rangeBase.push_back(baseVertex);
+        }
+        mesh.firstIndex = rangeFirst[r];
+        mesh.baseVertex = rangeBase[r];
+    }
+
+    arena.vertices.swap(vertices);
+    arena.indices.swap(indices);
+    report.verticesAfter = arena.vertices.size() / MeshArena::VERTEX_FLOATS;
+    report.indicesAfter = arena.indices.size();
+    report.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+// ------------------------------------------------------------------------
+inline void printMeshOptimization(const MeshOptimizationReport& report)
+{
+    printf("mesh optimizer: %d -> %d vertices, %d -> %d indices, ACMR %.3f -> %.3f (%d-entry FIFO) in %.2f ms\n",
+        (int)report.verticesBefore, (int)report.verticesAfter, (int)report.indicesBefore, (int)report.indicesAfter,
+        report.acmrBefore(), report.acmrAfter(), (int)mesh_optimizer_detail::FIFO_SIZE, report.milliseconds);
+}
+
+#endif
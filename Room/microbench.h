@@ -0,0 +1,306 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include "shader.h"
+#include "batch_transform.h"
+#include "transform_store.h"
+#include "cylinders.h"
+#include "mesh_optimizer.h"
+#include "light_clusters.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// average wall-clock nanoseconds per call of fn over the given number of iterations
+template <typename Fn>
+double nsPerCall(int iterations, Fn fn)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++)
+        fn(i);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+// Per-call cost of uploading the "model" matrix through the three setter paths:
+// the old name lookup in the driver, the reflected location table and a handle.
+// glFinish() after each run keeps queued driver work out of the next measurement.
+// ------------------------------------------------------------------------
+inline void benchUniformSetters(const Shader& shader, int iterations = 200000)
+{
+    shader.use();
+    glm::mat4 model(1.0f);
+
+    double driverLookup = nsPerCall(iterations, [&](int i) {
+        model[3][0] = (float)i;
+        const std::string name = "model";
+        glUniformMatrix4fv(glGetUniformLocation(shader.ID, name.c_str()), 1, GL_FALSE, &model[0][0]);
+    });
+    glFinish();
+
+    double cachedLookup = nsPerCall(iterations, [&](int i) {
+        model[3][0] = (float)i;
+        shader.setMat4("model", model);
+    });
+    glFinish();
+
+    UniformHandle handle = shader.uniform("model");
+    double handleSet = nsPerCall(iterations, [&](int i) {
+        model[3][0] = (float)i;
+        shader.setMat4(handle, model);
+    });
+    glFinish();
+
+    std::cout << "setMat4(\"model\") x " << iterations << std::endl;
+    std::cout << "  glGetUniformLocation per call : " << driverLookup << " ns/call" << std::endl;
+    std::cout << "  cached location table         : " << cachedLookup << " ns/call" << std::endl;
+    std::cout << "  UniformHandle                 : " << handleSet << " ns/call" << std::endl;
+}
+
+// the per-object matrix build of the fan rig before the transform store, five glm
+// matrices per object; the reference of benchTransforms()
+inline glm::mat4 transforamtion(float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz)
+{
+    glm::mat4 identityMatrix = glm::mat4(1.0f);
+    glm::mat4 translateMatrix, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix;
+    translateMatrix = glm::translate(identityMatrix, glm::vec3(tx, ty, tz));
+    rotateXMatrix = glm::rotate(identityMatrix, glm::radians(rx), glm::vec3(2.0f, 2.0f, 0.0f));
+    rotateYMatrix = glm::rotate(identityMatrix, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
+    rotateZMatrix = glm::rotate(identityMatrix, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
+    scaleMatrix = glm::scale(identityMatrix, glm::vec3(sx, sy, sz));
+    return translateMatrix * rotateXMatrix * rotateYMatrix * rotateZMatrix * scaleMatrix;
+}
+
+// Per-object cost of building viewProjection * world for a batch of objects: the
+// five-matrix transforamtion() followed by a glm multiply, against BatchTransform
+// composing the same SoA inputs, multiplying the whole batch by viewProjection
+// and transposing it to glm::mat4s for upload. Also checks that both agree. Then
+// the time of one TransformStore::update() on a 10000 transform hierarchy, with
+// every transform dirty and with a few subtrees dirty.
+// ------------------------------------------------------------------------
+inline void benchTransforms(int objects = 4096, int rounds = 200)
+{
+    // transforamtion() turns about a (2, 2, 0) axis instead of X, so the objects
+    // are only rotated about Y and Z
+    QuaternionSoA transforms;
+    transforms.resize(objects);
+    std::vector<glm::vec3> euler(objects);
+    for (int i = 0; i < objects; i++)
+    {
+        euler[i] = glm::vec3(0.0f, (float)(i * 7 % 360), (float)(i * 13 % 45));
+        transforms.set(i, glm::vec3(i % 16 * 0.5f, i % 7 * 0.25f, i / 16 * 0.5f),
+            TransformStore::fromEuler(euler[i]), glm::vec3(1.0f + i % 3, 0.5f, 2.0f));
+    }
+    glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 1.5f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(3.0f, 2.0f, 8.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<glm::mat4> scalar(objects), batched(objects);
+    double perMatrix = nsPerCall(rounds, [&](int) {
+        for (int i = 0; i < objects; i++)
+            scalar[i] = viewProjection * transforamtion(transforms.tx[i], transforms.ty[i], transforms.tz[i],
+                euler[i].x, euler[i].y, euler[i].z, transforms.sx[i], transforms.sy[i], transforms.sz[i]);
+    }) / objects;
+
+    MatrixSoA world, clip;
+    world.resize(objects);
+    double perBatch = nsPerCall(rounds, [&](int) {
+        BatchTransform::composeQuaternions(transforms, world, 0, objects);
+        BatchTransform::multiply(viewProjection, world, clip);
+        BatchTransform::unpack(clip, batched.data());
+    }) / objects;
+
+    float error = 0.0f;
+    for (int i = 0; i < objects; i++)
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++)
+                error = std::max(error, std::fabs(scalar[i][c][r] - batched[i][c][r]));
+
+    std::cout << "viewProjection * world for " << objects << " objects, " << batch_detail::LANES << " lanes" << std::endl;
+    std::cout << "  transforamtion() + glm multiply : " << perMatrix << " ns/object" << std::endl;
+    std::cout << "  BatchTransform                  : " << perBatch << " ns/object" << std::endl;
+    std::cout << "  largest difference              : " << error << std::endl;
+
+    // the store at ECS scale: 1000 roots of 9 children each, one root in 100 turned per update
+    TransformStore store;
+    for (int root = 0; root < 1000; root++)
+    {
+        int parent = store.add(-1, glm::vec3((float)root, 0.0f, 0.0f), glm::quat(), glm::vec3(1.0f));
+        for (int child = 0; child < 9; child++)
+            store.add(parent, glm::vec3(0.0f, (float)child, 0.0f), glm::quat(), glm::vec3(0.5f));
+    }
+    store.update();
+    double allDirty = nsPerCall(rounds, [&](int) {
+        for (size_t t = 0; t < store.size(); t++)
+            store.dirty[t] = 1;
+        store.update();
+    });
+    double fewDirty = nsPerCall(rounds, [&](int round) {
+        for (int root = round % 100; root < 1000; root += 100)
+            store.setRotation(root * 10, glm::angleAxis(round * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+        store.update();
+    });
+    std::cout << "TransformStore::update() of " << store.size() << " transforms" << std::endl;
+    std::cout << "  everything dirty                : " << allDirty / 1000.0 << " us" << std::endl;
+    std::cout << "  10 of 1000 subtrees dirty       : " << fewDirty / 1000.0 << " us" << std::endl;
+}
+
+// Load-time cost of procedural meshes: round table legs and lamp stands at
+// several resolutions, generated in turn into 64 slots of a preallocated buffer
+// the way a loader fills the mesh arena.
+// ------------------------------------------------------------------------
+inline void benchCylinders(int instances = 1000)
+{
+    static const int resolutions[][2] = { { 16, 1 }, { 64, 4 }, { 256, 16 } };
+    const int slots = 64;
+    std::cout << "Cylinders::generate() for " << instances << " meshes" << std::endl;
+    for (const auto& resolution : resolutions)
+    {
+        Cylinders leg = Cylinders::cylinder(0.15f, 1.2f, resolution[0], resolution[1]);
+        std::vector<float> vertices((size_t)leg.vertexCount() * 8 * slots);
+        std::vector<unsigned int> indices((size_t)leg.indexCount() * slots);
+        double perMesh = nsPerCall(instances, [&](int i) {
+            int slot = i % slots;
+            leg.generate(&vertices[(size_t)leg.vertexCount() * 8 * slot], &indices[(size_t)leg.indexCount() * slot],
+                VertexLayout(), (unsigned int)(leg.vertexCount() * slot));
+        });
+        printf("  %3d sectors x %2d stacks: %6d vertices, %6d triangles, %8.2f us/mesh, %6.1f M vertices/s\n",
+            resolution[0], resolution[1], leg.vertexCount(), leg.indexCount() / 3, perMesh / 1000.0, leg.vertexCount() / perMesh * 1000.0);
+    }
+}
+
+// Weld and cache reorder of one generated cylinder per resolution: vertex count and
+// ACMR before and after, and the time optimizeMeshes() takes
+// ------------------------------------------------------------------------
+inline void benchMeshOptimizer()
+{
+    static const int resolutions[][2] = { { 16, 1 }, { 64, 4 }, { 256, 16 } };
+    std::cout << "optimizeMeshes() on generated cylinders" << std::endl;
+    for (const auto& resolution : resolutions)
+    {
+        Cylinders leg = Cylinders::cylinder(0.15f, 1.2f, resolution[0], resolution[1]);
+        SceneGraph scene;
+        MeshArena arena;
+        GLint baseVertex;
+        GLuint firstIndex;
+        float* vertices = arena.allocateVertices(leg.vertexCount(), baseVertex);
+        unsigned int* indices = arena.allocateIndices(leg.indexCount(), firstIndex);
+        leg.generate(vertices, indices, VertexLayout::arena());
+        scene.addMesh(GL_TRIANGLES, leg.indexCount(), firstIndex, baseVertex);
+        MeshOptimizationReport report = optimizeMeshes(scene, arena);
+        printf("  %3d sectors x %2d stacks: %6d -> %6d vertices, ACMR %.3f -> %.3f, %8.2f ms\n", resolution[0], resolution[1],
+            (int)report.verticesBefore, (int)report.verticesAfter, report.acmrBefore(), report.acmrAfter(), report.milliseconds);
+    }
+}
+
+// view depth at which a ray from the eye leaves the rooms, the room boxes standing
+// in for their walls; direction has a view-space z of -1, so the ray parameter is
+// the view depth. 0 when the ray misses every room
+inline float roomDepth(const SceneGraph& scene, const glm::vec3& eye, const glm::vec3& direction)
+{
+    // entry and exit of the ray through a room's box
+    auto slab = [&](const SceneRoom& room, float& enter, float& leave) {
+        enter = 0.0f;
+        leave = 1e30f;
+        for (int a = 0; a < 3; a++)
+        {
+            float low = (room.boundsMin[a] - eye[a]) / direction[a], high = (room.boundsMax[a] - eye[a]) / direction[a];
+            enter = std::max(enter, std::min(low, high));
+            leave = std::min(leave, std::max(low, high));
+        }
+        return enter < leave;
+    };
+    float t = 1e30f, enter, leave;
+    for (const SceneRoom& room : scene.rooms)
+        if (slab(room, enter, leave))
+            t = std::min(t, enter);
+    if (t == 1e30f)
+        return 0.0f;
+    // walk through the rooms that join up along the ray
+    for (;;)
+    {
+        float next = t;
+        for (const SceneRoom& room : scene.rooms)
+            if (slab(room, enter, leave) && enter <= t + 1e-3f && leave > next)
+                next = leave;
+        if (next <= t + 1e-3f)
+            return t;
+        t = next;
+    }
+}
+
+// lights the clustered fragment shader loops over, averaged over a 150 x 80 grid of
+// fragments on the far side of the rooms
+inline float lightsPerRoomFragment(const SceneGraph& scene, const LightClusters& clusters, const glm::mat4& view, float fovy, float aspect)
+{
+    glm::mat4 toWorld = glm::inverse(view);
+    glm::vec3 eye(toWorld[3]);
+    float tanY = std::tan(fovy * 0.5f), tanX = tanY * aspect;
+    long long lights = 0;
+    int fragments = 0;
+    for (int y = 0; y < 80; y++)
+    {
+        for (int x = 0; x < 150; x++)
+        {
+            float u = (x + 0.5f) / 150.0f, v = (y + 0.5f) / 80.0f;
+            glm::vec3 direction(toWorld * glm::vec4((2.0f * u - 1.0f) * tanX, (2.0f * v - 1.0f) * tanY, -1.0f, 0.0f));
+            float depth = roomDepth(scene, eye, direction);
+            if (depth <= 0.0f)
+                continue;
+            lights += clusters.lightsAt(u, v, depth);
+            fragments++;
+        }
+    }
+    return fragments ? (float)lights / fragments : 0.0f;
+}
+
+// CPU cost of binning 4 to 256 lamps scattered over the three rooms into the light
+// clusters, seen from the start of the flythrough, on one thread and on four, with
+// the lights per fragment the shader then loops over; also checks that both
+// produce the same buffer. The first sweep keeps the ranges, so the lamps crowd
+// together as they grow in number; the second shrinks the ranges so every count
+// overlaps as much as 16 lamps do, and the cost per fragment should stay flat.
+// ------------------------------------------------------------------------
+inline void benchLightClusters(int rounds = 200)
+{
+    static const int counts[] = { 4, 16, 64, 256 };
+    const float fovy = glm::radians(45.0f), aspect = 1.875f;
+    glm::mat4 view = glm::lookAt(glm::vec3(-3.0f, 2.5f, 4.3f), glm::vec3(10.0f, 2.5f, 4.3f), glm::vec3(0.0f, 1.0f, 0.0f));
+    LightClusters single, pooled;
+    single.init(1);
+    pooled.init(4);
+    std::cout << "LightClusters::bin() into " << LightClusters::TILES_X << "x" << LightClusters::TILES_Y << "x"
+        << LightClusters::SLICES << " clusters" << std::endl;
+    for (int sweep = 0; sweep < 2; sweep++)
+    {
+        std::cout << (sweep == 0 ? "  ranges 2-4 m, density grows with the count" : "  ranges scaled by cbrt(16 / count), constant density") << std::endl;
+        for (int count : counts)
+        {
+            SceneGraph scene;
+            scene.addRoom("dining room", glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(10.0f, 5.0f, 10.0f));
+            scene.addRoom("bedroom", glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(22.5f, 5.0f, 10.0f));
+            scene.addRoom("room3", glm::vec3(10.0f, 0.0f, -5.0f), glm::vec3(22.5f, 5.0f, 0.0f));
+            scatterLights(scene, count, sweep == 0 ? 1.0f : std::cbrt(16.0f / count));
+            double oneThread = nsPerCall(rounds, [&](int) {
+                single.bin(scene, view, fovy, aspect, 0.1f, 100.0f);
+            }) / 1e6;
+            double pool = nsPerCall(rounds, [&](int) {
+                pooled.bin(scene, view, fovy, aspect, 0.1f, 100.0f);
+            }) / 1e6;
+            printf("    %3d lights: %7.3f ms on 1 thread, %7.3f ms on %d, %5.1f lights per fragment, %5.1f per lit cluster (max %d)%s\n",
+                count, oneThread, pool, pooled.threads, lightsPerRoomFragment(scene, pooled, view, fovy, aspect),
+                pooled.averageLights, pooled.maxLights, single.data == pooled.data ? "" : "  MISMATCH");
+        }
+    }
+    single.release();
+    pooled.release();
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef PORTAL_VISIBILITY_H
+#define PORTAL_VISIBILITY_H
+
+#include "frustum_culler.h"
+#include "render_stats.h"
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Cell and portal visibility for the multi-room layout. Every room is a cell (an
+// axis-aligned box) and every door or opening a rectangular portal between two
+// cells. From the camera's cell the view frustum is narrowed through each portal
+// it can see and the walk continues into the cell behind it; only cells reached
+// this way are drawn. Cell 0 is the outside, i.e. everything not inside a room:
+// it has no geometry of its own, so reaching it (or standing in it) falls back to
+// drawing every cell and leaves the rest to the frustum culler.
+class PortalVisibility
+{
+public:
+    static const int OUTSIDE = 0;
+
+    struct Cell
+    {
+        std::string name;
+        glm::vec3 boundsMin, boundsMax;
+        std::vector<int> nodes;     // scene nodes whose box overlaps the cell
+    };
+
+    struct Portal
+    {
+        int cells[2];
+        glm::vec3 corners[4];       // rectangle, in winding order
+    };
+
+    std::vector<Cell> cells;
+    std::vector<Portal> portals;
+    std::vector<unsigned char> cellVisible;
+    int maxDepth = 8;               // longest portal chain followed
+
+    PortalVisibility()
+    {
+        cells.push_back({ "outside", glm::vec3(0.0f), glm::vec3(0.0f), std::vector<int>() });
+    }
+
+    int addCell(const std::string& name, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        cells.push_back({ name, boundsMin, boundsMax, std::vector<int>() });
+        builtVersion = ~0u;
+        return (int)cells.size() - 1;
+    }
+
+    // axis-aligned opening between two cells; the box must be flat along one axis
+    // ------------------------------------------------------------------------
+    int addPortal(int cellA, int cellB, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        Portal portal;
+        portal.cells[0] = cellA;
+        portal.cells[1] = cellB;
+        glm::vec3 a = boundsMin, b = boundsMax;
+        if (a.x == b.x)
+        {
+            portal.corners[0] = glm::vec3(a.x, a.y, a.z);
+            portal.corners[1] = glm::vec3(a.x, b.y, a.z);
+            portal.corners[2] = glm::vec3(a.x, b.y, b.z);
+            portal.corners[3] = glm::vec3(a.x, a.y, b.z);
+        }
+        else if (a.z == b.z)
+        {
+            portal.corners[0] = glm::vec3(a.x, a.y, a.z);
+            portal.corners[1] = glm::vec3(b.x, a.y, a.z);
+            portal.corners[2] = glm::vec3(b.x, b.y, a.z);
+            portal.corners[3] = glm::vec3(a.x, b.y, a.z);
+        }
+        else
+        {
+            portal.corners[0] = glm::vec3(a.x, a.y, a.z);
+            portal.corners[1] = glm::vec3(b.x, a.y, a.z);
+            portal.corners[2] = glm::vec3(b.x, a.y, b.z);
+            portal.corners[3] = glm::vec3(a.x, a.y, b.z);
+        }
+        portals.push_back(portal);
+        return (int)portals.size() - 1;
+    }
+
+    // the room containing a point, OUTSIDE if none does
+    int cellAt(const glm::vec3& p) const
+    {
+        for (int c = 1; c < (int)cells.size(); c++)
+            if (p.x >= cells[c].boundsMin.x && p.x <= cells[c].boundsMax.x &&
+                p.y >= cells[c].boundsMin.y && p.y <= cells[c].boundsMax.y &&
+                p.z >= cells[c].boundsMin.z && p.z <= cells[c].boundsMax.z)
+                return c;
+        return OUTSIDE;
+    }
+
+    // Walk the portals from the eye and clear the visibility of every node that
+    // belongs only to unreached cells. Nodes outside all rooms are left alone.
+    // ------------------------------------------------------------------------
+    void cull(const glm::vec3& eye, const glm::mat4& viewProjection, FrustumCuller& culler)
+    {
+        assignNodes(culler);
+
+        cellVisible.assign(cells.size(), 0);
+        int start = cellAt(eye);
+        if (start != OUTSIDE)
+        {
+            glm::vec4 frustum[6];
+            FrustumCuller::extractPlanes(viewProjection, frustum);
+            visit(start, std::vector<glm::vec4>(frustum, frustum + 6), eye, -1, 0);
+        }
+        if (start == OUTSIDE || cellVisible[OUTSIDE])
+        {
+            cellVisible.assign(cells.size(), 1);
+            return;
+        }
+
+        std::vector<unsigned char> reached(culler.visible.size(), 0);
+        for (int c = 1; c < (int)cells.size(); c++)
+            if (cellVisible[c])
+                for (int n : cells[c].nodes)
+                    reached[n] = 1;
+        for (size_t n = 0; n < culler.visible.size(); n++)
+        {
+            if (culler.visible[n] && !reached[n] && inAnyCell[n])
+            {
+                culler.visible[n] = 0;
+                culler.visibleCount--;
+                renderStats().culled++;
+            }
+        }
+    }
+
+private:
+    unsigned int builtVersion = ~0u;
+    std::vector<unsigned char> inAnyCell;
+
+    // a node belongs to every cell its box overlaps, so shared walls stay with both rooms
+    void assignNodes(const FrustumCuller& culler)
+    {
+        if (culler.boxesVersion() == builtVersion)
+            return;
+        builtVersion = culler.boxesVersion();
+
+        const float slack = 0.1f;
+        int count = (int)culler.visible.size();
+        inAnyCell.assign(count, 0);
+        for (Cell& cell : cells)
+            cell.nodes.clear();
+        for (int n = 0; n < count; n++)
+        {
+            glm::vec3 center, extent;
+            culler.nodeBox(n, center, extent);
+            for (int c = 1; c < (int)cells.size(); c++)
+            {
+                glm::vec3 lo = cells[c].boundsMin - slack, hi = cells[c].boundsMax + slack;
+                if (center.x + extent.x >= lo.x && center.x - extent.x <= hi.x &&
+                    center.y + extent.y >= lo.y && center.y - extent.y <= hi.y &&
+                    center.z + extent.z >= lo.z && center.z - extent.z <= hi.z)
+                {
+                    cells[c].nodes.push_back(n);
+                    inAnyCell[n] = 1;
+                }
+            }
+        }
+    }
+
+    void visit(int cell, const std::vector<glm::vec4>& planes, const glm::vec3& eye, int fromPortal, int depth)
+    {
+        cellVisible[cell] = 1;
+        if (cell == OUTSIDE || depth >= maxDepth)
+            return;
+        for (int p = 0; p < (int)portals.size(); p++)
+        {
+            const Portal& portal = portals[p];
+            if (p == fromPortal || (portal.cells[0] != cell && portal.cells[1] != cell))
+                continue;
+            int next = portal.cells[0] == cell ? portal.cells[1] : portal.cells[0];
+
+            std::vector<glm::vec3> polygon(portal.corners, portal.corners + 4);
+            for (const glm::vec4& plane : planes)
+            {
+                clip(polygon, plane);
+                if (polygon.size() < 3)
+                    break;
+            }
+            if (polygon.size() < 3)
+                continue;
+
+            // standing in the doorway: the narrowed frustum would be degenerate, look through unchanged
+            glm::vec3 normal = glm::normalize(glm::cross(portal.corners[1] - portal.corners[0], portal.corners[2] - portal.corners[0]));
+            if (std::fabs(glm::dot(normal, eye - portal.corners[0])) < 0.05f)
+            {
+                visit(next, planes, eye, p, depth + 1);
+                continue;
+            }
+
+            // planes through the eye and each edge of the visible part of the portal
+            glm::vec3 centroid(0.0f);
+            for (const glm::vec3& v : polygon)
+                centroid += v;
+            centroid /= (float)polygon.size();
+            std::vector<glm::vec4> narrowed;
+            for (size_t i = 0; i < polygon.size(); i++)
+            {
+                glm::vec3 n = glm::cross(polygon[i] - eye, polygon[(i + 1) % polygon.size()] - eye);
+                if (glm::dot(n, n) < 1e-12f)
+                    continue;
+                if (glm::dot(n, centroid - eye) < 0.0f)
+                    n = -n;
+                narrowed.push_back(glm::vec4(n, -glm::dot(n, eye)));
+            }
+            narrowed.push_back(planes.back());     // keep the far plane
+            visit(next, narrowed, eye, p, depth + 1);
+        }
+    }
+
+    // Sutherland-Hodgman against one plane, keeps the inside part
+    static void clip(std::vector<glm::vec3>& polygon, const glm::vec4& plane)
+    {
+        std::vector<glm::vec3> out;
+        for (size_t i = 0; i < polygon.size(); i++)
+        {
+            const glm::vec3& a = polygon[i];
+            const glm::vec3& b = polygon[(i + 1) % polygon.size()];
+            float da = glm::dot(glm::vec3(plane), a) + plane.w;
+            float db = glm::dot(glm::vec3(plane), b) + plane.w;
+            if (da >= 0.0f)
+                out.push_back(a);
+            if ((da >= 0.0f) != (db >= 0.0f))
+                out.push_back(a + (b - a) * (da / (da - db)));
+        }
+        polygon.swap(out);
+    }
+};
+
+#endif
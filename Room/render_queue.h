@@ -0,0 +1,151 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "scene_graph.h"
+#include "frustum_culler.h"
+#include "lod_selector.h"
+#include "render_stats.h"
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Draw items of one frame, ordered by a 64-bit key before submission:
+//
+//   63..56 program   55..44 mesh   43..32 material   31..0 view depth
+//
+// Sorting groups the items by program and mesh, keeps equal materials together
+// and goes front to back inside a material so the depth test rejects hidden
+// fragments early. Consecutive items with the same program and mesh are merged
+// into one batch, drawn with a single instanced call.
+class RenderQueue
+{
+public:
+    struct Batch
+    {
+        int program;
+        int mesh;
+        int first;      // first item of the batch
+        int count;
+    };
+
+    std::vector<uint64_t> keys;
+    std::vector<int> nodes;         // scene node of every item, parallel to keys
+    std::vector<Batch> batches;     // filled by sort() or merge()
+    int stateChangesSaved = 0;      // by the last sort()
+
+    static uint64_t makeKey(unsigned int program, unsigned int mesh, unsigned int material, float depth)
+    {
+        // non-negative floats order like their bit patterns; items around the eye sort first
+        uint32_t depthBits = 0;
+        if (depth > 0.0f)
+            memcpy(&depthBits, &depth, sizeof(depthBits));
+        return ((uint64_t)(program & 0xFF) << 56) | ((uint64_t)(mesh & 0xFFF) << 44) |
+            ((uint64_t)(material & 0xFFF) << 32) | depthBits;
+    }
+
+    void clear()
+    {
+        keys.clear();
+        nodes.clear();
+        batches.clear();
+    }
+
+    void push(uint64_t key, int node)
+    {
+        keys.push_back(key);
+        nodes.push_back(node);
+    }
+
+    // every node the culler left visible at its selected level of detail, keyed by
+    // the view depth of its box centre
+    // ------------------------------------------------------------------------
+    void collect(const SceneGraph& scene, const FrustumCuller& culler, const LodSelector& lod, const glm::mat4& view, unsigned int program = 0)
+    {
+        clear();
+        for (int n = 0; n < (int)scene.nodes.size(); n++)
+        {
+            if (!culler.visible[n])
+                continue;
+            glm::vec3 center, extent;
+            culler.nodeBox(n, center, extent);
+            float depth = -(view[0][2] * center.x + view[1][2] * center.y + view[2][2] * center.z + view[3][2]);
+            push(makeKey(program, lod.meshes[n], scene.nodes[n].material, depth), n);
+        }
+    }
+
+    // radix sort the items by key, then merge them into batches
+    // ------------------------------------------------------------------------
+    void sort()
+    {
+        int before = stateSwitches();
+        radixSort();
+        merge();
+        stateChangesSaved = before - stateSwitches();
+        renderStats().stateChangesSaved += stateChangesSaved;
+    }
+
+    // merge runs of items that share program and mesh, in the current order
+    // ------------------------------------------------------------------------
+    void merge()
+    {
+        batches.clear();
+        for (int i = 0; i < (int)keys.size(); i++)
+        {
+            int program = (int)(keys[i] >> 56);
+            int mesh = (int)((keys[i] >> 44) & 0xFFF);
+            if (batches.empty() || batches.back().program != program || batches.back().mesh != mesh)
+                batches.push_back({ program, mesh, i, 0 });
+            batches.back().count++;
+        }
+    }
+
+private:
+    std::vector<uint64_t> keyScratch;
+    std::vector<int> nodeScratch;
+
+    // program, mesh or material switches when the items are drawn in their current order
+    int stateSwitches() const
+    {
+        int switches = keys.empty() ? 0 : 1;
+        for (size_t i = 1; i < keys.size(); i++)
+            if ((keys[i] >> 32) != (keys[i - 1] >> 32))
+                switches++;
+        return switches;
+    }
+
+    // LSD radix sort, one byte per pass; a pass is skipped when every key has the
+    // same byte there, which drops the unused program bits
+    void radixSort()
+    {
+        size_t count = keys.size();
+        keyScratch.resize(count);
+        nodeScratch.resize(count);
+        for (int shift = 0; shift < 64 && count > 1; shift += 8)
+        {
+            size_t histogram[256] = {};
+            for (uint64_t key : keys)
+                histogram[(key >> shift) & 0xFF]++;
+            if (histogram[(keys[0] >> shift) & 0xFF] == count)
+                continue;
+            size_t offset = 0;
+            for (int b = 0; b < 256; b++)
+            {
+                size_t bucket = histogram[b];
+                histogram[b] = offset;
+                offset += bucket;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t slot = histogram[(keys[i] >> shift) & 0xFF]++;
+                keyScratch[slot] = keys[i];
+                nodeScratch[slot] = nodes[i];
+            }
+            keys.swap(keyScratch);
+            nodes.swap(nodeScratch);
+        }
+    }
+};
+
+#endif
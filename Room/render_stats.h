@@ -0,0 +1,43 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <glad/glad.h>
+
+// Counters of the GL work submitted in a frame, bumped by the renderers and the
+// Shader setters and reset by the caller at the start of every frame. State
+// changes are program, vertex array and buffer binds, attribute setup and
+// uniform uploads.
+struct RenderStats
+{
+    long long drawCalls = 0;
+    long long stateChanges = 0;
+    long long triangles = 0;
+    long long culled = 0;           // scene nodes rejected before submission
+    long long stateChangesSaved = 0;    // program/mesh/material switches avoided by sorting
+
+    void reset()
+    {
+        drawCalls = stateChanges = triangles = culled = stateChangesSaved = 0;
+    }
+};
+
+inline RenderStats& renderStats()
+{
+    static RenderStats stats;
+    return stats;
+}
+
+inline void countStateChange(int changes = 1)
+{
+    renderStats().stateChanges += changes;
+}
+
+inline void countDraw(GLenum mode, GLsizei count, GLsizei instances = 1)
+{
+    RenderStats& stats = renderStats();
+    stats.drawCalls++;
+    if (mode == GL_TRIANGLES)
+        stats.triangles += (long long)(count / 3) * instances;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef RUN_OPTIONS_H
+#define RUN_OPTIONS_H
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// command line switches of the room executable
+struct RunOptions
+{
+    bool benchUniforms = false;     // --bench-uniforms: uniform setter microbenchmark
+    bool benchTransforms = false;   // --bench-transforms: batch matrix and TransformStore update microbenchmark
+    bool benchMeshes = false;       // --bench-meshes: procedural mesh generation microbenchmark
+    bool benchLights = false;       // --bench-lights: light cluster binning microbenchmark
+    bool headless = false;          // --headless: offscreen render, no window
+    int frames = 0;                 // --frames N, 0 picks the mode's default
+    std::string output = "frame_%04d.png";  // --output PATTERN, printf-style frame number; .ppm or .png
+    std::string cameraPath;         // --camera-path FILE, default is the built-in walkthrough
+    bool overlay = false;           // --overlay: frame timing bars, toggled with T
+    std::string timingCSV;          // --timing-csv FILE: per-frame phase times on exit
+    std::string timingJSON;         // --timing-json FILE: rolling p50/p95/p99 on exit
+    bool benchmark = false;         // --benchmark: replay camera input with a fixed timestep and report
+    std::string replay;             // --replay FILE, default is the built-in flythrough
+    std::string record;             // --record FILE: save the interactive camera input on exit
+    float timestep = 1.0f / 60.0f;  // --timestep SECONDS used by --benchmark
+    bool frustumCulling = true;     // --no-cull: skip the view frustum test
+    bool portalCulling = true;      // --no-portals: draw every room
+    bool sortQueue = true;          // --no-sort: submit in scene order, merging only neighbours
+    bool lod = true;                // --no-lod: always draw the finest level of detail
+    bool pack = true;               // --no-pack: float vertices and 32-bit indices in the GL buffers
+    bool indirect = true;           // --no-indirect: draw through the render queue even if multi-draw indirect is available
+    bool clusters = true;           // --no-clusters: shade with the per-object light lists
+    int lights = 0;                 // --lights N: scatter N extra lamps over the rooms
+    std::string scene;              // --scene FILE: load a .rscn scene instead of the built-in rooms
+    std::string exportScene;        // --export-scene FILE: write the built-in rooms as .rscn or .json and exit
+    bool shaderCache = true;        // --no-shader-cache: always compile the shaders from source
+    bool watch = false;             // --watch: reload the shaders and the --scene file when they change
+};
+
+// returns false on an unknown switch or a missing value
+// ------------------------------------------------------------------------
+inline bool parseRunOptions(int argc, char** argv, RunOptions& options)
+{
+    for (int a = 1; a < argc; a++)
+    {
+        bool hasValue = a + 1 < argc;
+        if (strcmp(argv[a], "--bench-uniforms") == 0)
+            options.benchUniforms = true;
+        else if (strcmp(argv[a], "--bench-transforms") == 0)
+            options.benchTransforms = true;
+        else if (strcmp(argv[a], "--bench-meshes") == 0)
+            options.benchMeshes = true;
+        else if (strcmp(argv[a], "--bench-lights") == 0)
+            options.benchLights = true;
+        else if (strcmp(argv[a], "--headless") == 0)
+            options.headless = true;
+        else if (strcmp(argv[a], "--frames") == 0 && hasValue)
+            options.frames = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--output") == 0 && hasValue)
+            options.output = argv[++a];
+        else if (strcmp(argv[a], "--camera-path") == 0 && hasValue)
+            options.cameraPath = argv[++a];
+        else if (strcmp(argv[a], "--overlay") == 0)
+            options.overlay = true;
+        else if (strcmp(argv[a], "--timing-csv") == 0 && hasValue)
+            options.timingCSV = argv[++a];
+        else if (strcmp(argv[a], "--timing-json") == 0 && hasValue)
+            options.timingJSON = argv[++a];
+        else if (strcmp(argv[a], "--no-cull") == 0)
+            options.frustumCulling = false;
+        else if (strcmp(argv[a], "--no-portals") == 0)
+            options.portalCulling = false;
+        else if (strcmp(argv[a], "--no-sort") == 0)
+            options.sortQueue = false;
+        else if (strcmp(argv[a], "--no-lod") == 0)
+            options.lod = false;
+        else if (strcmp(argv[a], "--no-pack") == 0)
+            options.pack = false;
+        else if (strcmp(argv[a], "--no-indirect") == 0)
+            options.indirect = false;
+        else if (strcmp(argv[a], "--no-clusters") == 0)
+            options.clusters = false;
+        else if (strcmp(argv[a], "--lights") == 0 && hasValue)
+            options.lights = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--scene") == 0 && hasValue)
+            options.scene = argv[++a];
+        else if (strcmp(argv[a], "--export-scene") == 0 && hasValue)
+            options.exportScene = argv[++a];
+        else if (strcmp(argv[a], "--no-shader-cache") == 0)
+            options.shaderCache = false;
+        else if (strcmp(argv[a], "--watch") == 0)
+            options.watch = true;
+        else if (strcmp(argv[a], "--benchmark") == 0)
+            options.benchmark = true;
+        else if (strcmp(argv[a], "--replay") == 0 && hasValue)
+            options.replay = argv[++a];
+        else if (strcmp(argv[a], "--record") == 0 && hasValue)
+            options.record = argv[++a];
+        else if (strcmp(argv[a], "--timestep") == 0 && hasValue)
+            options.timestep = (float)atof(argv[++a]);
+        else
+        {
+            std::cout << "Unknown or incomplete option " << argv[a] << std::endl;
+            std::cout << "usage: 3D [--bench-uniforms] [--bench-transforms] [--bench-meshes] [--bench-lights] [--headless] [--frames N] [--output frame_%04d.png] [--camera-path FILE]" << std::endl;
+            std::cout << "          [--overlay] [--timing-csv FILE] [--timing-json FILE]" << std::endl;
+            std::cout << "          [--benchmark [--replay FILE] [--timestep SECONDS]] [--record FILE] [--no-cull] [--no-portals] [--no-sort]" << std::endl;
+            std::cout << "          [--no-indirect] [--no-lod] [--no-pack] [--no-clusters] [--lights N]" << std::endl;
+            std::cout << "          [--scene FILE] [--export-scene FILE] [--watch] [--no-shader-cache]" << std::endl;
+            return false;
+        }
+    }
+    if (options.frames < 0 || options.timestep <= 0.0f || options.lights < 0)
+    {
+        std::cout << "--frames, --timestep and --lights must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
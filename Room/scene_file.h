@@ -0,0 +1,684 @@
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include "scene_graph.h"
+#include "mesh_arena.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Binary scene file (.rscn). Little-endian, every section 16-byte aligned, laid out
+// so a mapped file is used in place: the GL layout sections go to glBufferData as
+// they are and the tables are plain arrays of the structs below. The float and
+// 32-bit sections are what MeshArena keeps on the CPU, read only for --watch, for
+// --no-pack, or when the geometry does not fit the packed layout (then the GL
+// layout offsets point at them and nothing is stored twice).
+//
+//   SceneFileHeader
+//   float    vertices[vertexCount * 9]        position + normal + colour, as in MeshArena
+//   uint32_t indices[indexCount]
+//   MeshArena::PackedVertex gpuVertices[vertexCount]    if SCENE_PACKED_VERTICES
+//   uint16_t gpuIndices[indexCount]                     if SCENE_SHORT_INDICES
+//   SceneFileMesh     meshes[meshCount]         a coarser level of detail follows its mesh
+//   SceneFileMaterial materials[materialCount]
+//   SceneFileNode     nodes[nodeCount]
+//   SceneFileRoom     rooms[roomCount]
+//   SceneFilePortal   portals[portalCount]
+//   SceneFileFan      fans[fanCount]
+//   SceneFileComposite composites[compositeCount]
+//   SceneFilePart     parts[partCount]            parts of all composites, in order
+//   SceneFileInstance instances[instanceCount]
+//   SceneFileLight    lights[lightCount]
+//
+// A node with an instance is a part of it and placed relative to the instance.
+// sourceHash identifies the text scene a file was compiled from, 0 for exports.
+const char SCENE_FILE_MAGIC[4] = { 'R', 'S', 'C', 'N' };
+const uint32_t SCENE_FILE_VERSION = 7;
+
+// gpuLayout flags, the format of the GL layout sections
+const uint32_t SCENE_PACKED_VERTICES = 1;
+const uint32_t SCENE_SHORT_INDICES = 2;
+
+struct SceneFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexCount, indexCount, meshCount, materialCount, nodeCount;
+    uint32_t roomCount, portalCount, fanCount;
+    uint32_t compositeCount, partCount, instanceCount, lightCount;
+    uint32_t gpuLayout, reserved;
+    uint64_t sourceHash;
+    uint64_t verticesOffset, indicesOffset, gpuVerticesOffset, gpuIndicesOffset;
+    uint64_t meshesOffset, materialsOffset, nodesOffset;
+    uint64_t roomsOffset, portalsOffset, fansOffset;
+    uint64_t compositesOffset, partsOffset, instancesOffset, lightsOffset;
+    uint64_t fileSize;
+};
+
+struct SceneFileMesh
+{
+    char name[24];
+    uint32_t mode;
+    int32_t count;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    float boundsMin[3], boundsMax[3];
+    int32_t lodNext;        // coarser mesh, -1 for none
+    float lodBelow;
+};
+
+struct SceneFileMaterial
+{
+    char name[24];
+    float color[3];
+    float reserved;
+};
+
+struct SceneFileNode
+{
+    float translate[3], rotate[3], scale[3];
+    int32_t mesh, material;
+    int32_t instance;       // -1 for a node placed on its own
+};
+
+struct SceneFileRoom
+{
+    char name[24];
+    float boundsMin[3], boundsMax[3];
+};
+
+struct SceneFilePortal
+{
+    int32_t rooms[2];       // -1 is the outside
+    float boundsMin[3], boundsMax[3];
+};
+
+struct SceneFileFan
+{
+    float offset[3];
+    int32_t mesh, material;
+    int32_t instance;       // -1 for a rig placed on its own
+    uint32_t reserved[2];
+};
+
+struct SceneFileComposite
+{
+    char name[24];
+    uint32_t firstPart, partCount;
+};
+
+struct SceneFilePart
+{
+    float translate[3], rotate[3], scale[3];
+    int32_t mesh, material;
+    uint32_t reserved;
+};
+
+struct SceneFileInstance
+{
+    float translate[3], rotate[3], scale[3];
+    int32_t composite;
+    uint32_t reserved[2];
+};
+
+struct SceneFileLight
+{
+    int32_t type;           // LightType
+    float position[3], direction[3], color[3];
+    float range, innerCone, outerCone;
+    uint32_t reserved[3];
+};
+
+// read-only view of a whole file, mmap on POSIX and a file mapping on Windows
+class MappedFile
+{
+public:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    bool open(const std::string& path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        size = (size_t)fileSize.QuadPart;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping)
+            return false;
+        data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        return data != nullptr;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        size = (size_t)info.st_size;
+        void* view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+        data = (const unsigned char*)view;
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (data)
+            UnmapViewOfFile(data);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data)
+            munmap((void*)data, size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+};
+
+namespace scene_file_detail
+{
+    inline uint64_t align16(uint64_t offset)
+    {
+        return (offset + 15) & ~(uint64_t)15;
+    }
+
+    inline void copyName(char (&dst)[24], const std::string& name)
+    {
+        memset(dst, 0, sizeof(dst));
+        memcpy(dst, name.c_str(), std::min(name.size(), sizeof(dst) - 1));
+    }
+
+    inline bool sectionFits(const SceneFileHeader& header, uint64_t offset, uint64_t count, uint64_t elementSize)
+    {
+        return offset % 16 == 0 && offset <= header.fileSize && count <= (header.fileSize - offset) / elementSize;
+    }
+
+    // the largest of count indices from first, in a 16 or 32-bit index section
+    inline uint32_t largestIndex(const unsigned char* indices, bool shortIndices, uint32_t first, int32_t count)
+    {
+        uint32_t largest = 0;
+        if (shortIndices)
+        {
+            const uint16_t* values = (const uint16_t*)indices + first;
+            for (int32_t i = 0; i < count; i++)
+                largest = std::max(largest, (uint32_t)values[i]);
+        }
+        else
+        {
+            const uint32_t* values = (const uint32_t*)indices + first;
+            for (int32_t i = 0; i < count; i++)
+                largest = std::max(largest, values[i]);
+        }
+        return largest;
+    }
+
+    inline bool knownMode(uint32_t mode)
+    {
+        return mode == GL_TRIANGLES || mode == GL_LINES || mode == GL_LINE_LOOP || mode == GL_LINE_STRIP;
+    }
+}
+
+// export a scene built in memory; the arena must still hold its CPU copies
+// ------------------------------------------------------------------------
+inline bool writeSceneFile(const std::string& path, const SceneGraph& scene, const MeshArena& arena, uint64_t sourceHash = 0)
+{
+    using namespace scene_file_detail;
+
+    SceneFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SCENE_FILE_MAGIC, 4);
+    header.version = SCENE_FILE_VERSION;
+    header.vertexCount = (uint32_t)(arena.vertices.size() / MeshArena::VERTEX_FLOATS);
+    header.indexCount = (uint32_t)arena.indices.size();
+    header.meshCount = (uint32_t)scene.meshes.size();
+    header.materialCount = (uint32_t)scene.materials.size();
+    header.nodeCount = (uint32_t)scene.nodes.size();
+    header.roomCount = (uint32_t)scene.rooms.size();
+    header.portalCount = (uint32_t)scene.portals.size();
+    header.fanCount = (uint32_t)scene.fans.size();
+    header.compositeCount = (uint32_t)scene.composites.size();
+    for (const SceneComposite& composite : scene.composites)
+        header.partCount += (uint32_t)composite.parts.size();
+    header.instanceCount = (uint32_t)scene.instances.size();
+    header.lightCount = (uint32_t)scene.lights.size();
+    header.sourceHash = sourceHash;
+    std::vector<MeshArena::PackedVertex> packed;
+    std::vector<uint16_t> shortIndices;
+    MeshArena::packLayout(arena.vertices.data(), header.vertexCount, arena.indices.data(), header.indexCount, packed, shortIndices);
+    header.gpuLayout = (packed.empty() ? 0 : SCENE_PACKED_VERTICES) | (shortIndices.empty() ? 0 : SCENE_SHORT_INDICES);
+    header.verticesOffset = align16(sizeof(SceneFileHeader));
+    header.indicesOffset = align16(header.verticesOffset + arena.vertices.size() * sizeof(float));
+    uint64_t end = align16(header.indicesOffset + arena.indices.size() * sizeof(uint32_t));
+    header.gpuVerticesOffset = packed.empty() ? header.verticesOffset : end;
+    end = align16(end + packed.size() * sizeof(MeshArena::PackedVertex));
+    header.gpuIndicesOffset = shortIndices.empty() ? header.indicesOffset : end;
+    header.meshesOffset = align16(end + shortIndices.size() * sizeof(uint16_t));
+    header.materialsOffset = align16(header.meshesOffset + header.meshCount * sizeof(SceneFileMesh));
+    header.nodesOffset = align16(header.materialsOffset + header.materialCount * sizeof(SceneFileMaterial));
+    header.roomsOffset = align16(header.nodesOffset + header.nodeCount * sizeof(SceneFileNode));
+    header.portalsOffset = align16(header.roomsOffset + header.roomCount * sizeof(SceneFileRoom));
+    header.fansOffset = align16(header.portalsOffset + header.portalCount * sizeof(SceneFilePortal));
+    header.compositesOffset = align16(header.fansOffset + header.fanCount * sizeof(SceneFileFan));
+    header.partsOffset = align16(header.compositesOffset + header.compositeCount * sizeof(SceneFileComposite));
+    header.instancesOffset = align16(header.partsOffset + header.partCount * sizeof(SceneFilePart));
+    header.lightsOffset = align16(header.instancesOffset + header.instanceCount * sizeof(SceneFileInstance));
+    header.fileSize = header.lightsOffset + header.lightCount * sizeof(SceneFileLight);
+
+    std::vector<unsigned char> file((size_t)header.fileSize, 0);
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + header.verticesOffset, arena.vertices.data(), arena.vertices.size() * sizeof(float));
+    memcpy(file.data() + header.indicesOffset, arena.indices.data(), arena.indices.size() * sizeof(uint32_t));
+    if (!packed.empty())
+        memcpy(file.data() + header.gpuVerticesOffset, packed.data(), packed.size() * sizeof(MeshArena::PackedVertex));
+    if (!shortIndices.empty())
+        memcpy(file.data() + header.gpuIndicesOffset, shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+
+    SceneFileMesh* meshes = (SceneFileMesh*)(file.data() + header.meshesOffset);
+    for (uint32_t m = 0; m < header.meshCount; m++)
+    {
+        const Mesh& mesh = scene.meshes[m];
+        copyName(meshes[m].name, scene.meshNames[m]);
+        meshes[m].mode = mesh.mode;
+        meshes[m].count = mesh.count;
+        meshes[m].firstIndex = mesh.firstIndex;
+        meshes[m].baseVertex = mesh.baseVertex;
+        meshes[m].lodNext = mesh.lodNext;
+        meshes[m].lodBelow = mesh.lodBelow;
+        for (int a = 0; a < 3; a++)
+        {
+            meshes[m].boundsMin[a] = mesh.boundsMin[a];
+            meshes[m].boundsMax[a] = mesh.boundsMax[a];
+        }
+    }
+    SceneFileMaterial* materials = (SceneFileMaterial*)(file.data() + header.materialsOffset);
+    for (uint32_t m = 0; m < header.materialCount; m++)
+    {
+        copyName(materials[m].name, scene.materialNames[m]);
+        for (int a = 0; a < 3; a++)
+            materials[m].color[a] = scene.materials[m].color[a];
+    }
+    SceneFileNode* nodes = (SceneFileNode*)(file.data() + header.nodesOffset);
+    for (uint32_t n = 0; n < header.nodeCount; n++)
+    {
+        const SceneNode& node = scene.nodes[n];
+        for (int a = 0; a < 3; a++)
+        {
+            nodes[n].translate[a] = node.translate[a];
+            nodes[n].rotate[a] = node.rotate[a];
+            nodes[n].scale[a] = node.scale[a];
+        }
+        nodes[n].mesh = node.mesh;
+        nodes[n].material = node.material;
+        nodes[n].instance = node.instance;
+    }
+    SceneFileRoom* rooms = (SceneFileRoom*)(file.data() + header.roomsOffset);
+    for (uint32_t r = 0; r < header.roomCount; r++)
+    {
+        copyName(rooms[r].name, scene.rooms[r].name);
+        for (int a = 0; a < 3; a++)
+        {
+            rooms[r].boundsMin[a] = scene.rooms[r].boundsMin[a];
+            rooms[r].boundsMax[a] = scene.rooms[r].boundsMax[a];
+        }
+    }
+    SceneFilePortal* portals = (SceneFilePortal*)(file.data() + header.portalsOffset);
+    for (uint32_t p = 0; p < header.portalCount; p++)
+    {
+        const ScenePortal& portal = scene.portals[p];
+        portals[p].rooms[0] = portal.rooms[0];
+        portals[p].rooms[1] = portal.rooms[1];
+        for (int a = 0; a < 3; a++)
+        {
+            portals[p].boundsMin[a] = portal.boundsMin[a];
+            portals[p].boundsMax[a] = portal.boundsMax[a];
+        }
+    }
+    SceneFileFan* fans = (SceneFileFan*)(file.data() + header.fansOffset);
+    for (uint32_t f = 0; f < header.fanCount; f++)
+    {
+        for (int a = 0; a < 3; a++)
+            fans[f].offset[a] = scene.fans[f].offset[a];
+        fans[f].mesh = scene.fans[f].mesh;
+        fans[f].material = scene.fans[f].material;
+        fans[f].instance = scene.fans[f].instance;
+    }
+    SceneFileComposite* composites = (SceneFileComposite*)(file.data() + header.compositesOffset);
+    SceneFilePart* parts = (SceneFilePart*)(file.data() + header.partsOffset);
+    uint32_t partIndex = 0;
+    for (uint32_t c = 0; c < header.compositeCount; c++)
+    {
+        const SceneComposite& composite = scene.composites[c];
+        copyName(composites[c].name, composite.name);
+        composites[c].firstPart = partIndex;
+        composites[c].partCount = (uint32_t)composite.parts.size();
+        for (const ScenePart& part : composite.parts)
+        {
+            for (int a = 0; a < 3; a++)
+            {
+                parts[partIndex].translate[a] = part.translate[a];
+                parts[partIndex].rotate[a] = part.rotate[a];
+                parts[partIndex].scale[a] = part.scale[a];
+            }
+            parts[partIndex].mesh = part.mesh;
+            parts[partIndex].material = part.material;
+            partIndex++;
+        }
+    }
+    SceneFileInstance* instances = (SceneFileInstance*)(file.data() + header.instancesOffset);
+    for (uint32_t i = 0; i < header.instanceCount; i++)
+    {
+        const SceneInstance& instance = scene.instances[i];
+        for (int a = 0; a < 3; a++)
+        {
+            instances[i].translate[a] = instance.translate[a];
+            instances[i].rotate[a] = instance.rotate[a];
+            instances[i].scale[a] = instance.scale[a];
+        }
+        instances[i].composite = instance.composite;
+    }
+    SceneFileLight* lights = (SceneFileLight*)(file.data() + header.lightsOffset);
+    for (uint32_t l = 0; l < header.lightCount; l++)
+    {
+        const SceneLight& light = scene.lights[l];
+        lights[l].type = light.type;
+        for (int a = 0; a < 3; a++)
+        {
+            lights[l].position[a] = light.position[a];
+            lights[l].direction[a] = light.direction[a];
+            lights[l].color[a] = light.color[a];
+        }
+        lights[l].range = light.range;
+        lights[l].innerCone = light.innerCone;
+        lights[l].outerCone = light.outerCone;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char*)file.data(), file.size());
+    if (!out)
+    {
+        std::cout << "Cannot write scene file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// source hash of a compiled scene file without mapping it; false if the file is
+// missing or not a current scene file
+// ------------------------------------------------------------------------
+inline bool readSceneFileHash(const std::string& path, uint64_t& sourceHash)
+{
+    SceneFileHeader header;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read((char*)&header, sizeof(header)))
+        return false;
+    if (memcmp(header.magic, SCENE_FILE_MAGIC, 4) != 0 || header.version != SCENE_FILE_VERSION)
+        return false;
+    sourceHash = header.sourceHash;
+    return true;
+}
+
+// Map a scene file, upload its GL layout sections directly from the mapping and
+// fill the scene tables. The header, the table ranges and every mesh's indices
+// are validated, so no draw reads past the vertex buffer; the mapping is released
+// once the data is in GL buffers. With the arena's packing
+// off, packed sections are skipped and the float ones uploaded. Without upload the
+// float geometry is copied into the arena's CPU copies instead and no GL call is
+// made.
+// ------------------------------------------------------------------------
+inline bool loadSceneFile(const std::string& path, SceneGraph& scene, MeshArena& arena, bool upload = true)
+{
+    using namespace scene_file_detail;
+
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cout << "Cannot map scene file " << path << std::endl;
+        return false;
+    }
+    SceneFileHeader header;
+    if (file.size < sizeof(header))
+    {
+        std::cout << path << ": not a scene file" << std::endl;
+        return false;
+    }
+    memcpy(&header, file.data, sizeof(header));
+    if (memcmp(header.magic, SCENE_FILE_MAGIC, 4) != 0 || header.version != SCENE_FILE_VERSION || header.fileSize != file.size)
+    {
+        std::cout << path << ": not a version " << SCENE_FILE_VERSION << " scene file" << std::endl;
+        return false;
+    }
+    if (!sectionFits(header, header.verticesOffset, (uint64_t)header.vertexCount * MeshArena::VERTEX_FLOATS, sizeof(float)) ||
+        !sectionFits(header, header.indicesOffset, header.indexCount, sizeof(uint32_t)) ||
+        !sectionFits(header, header.gpuVerticesOffset, header.vertexCount,
+            (header.gpuLayout & SCENE_PACKED_VERTICES) ? sizeof(MeshArena::PackedVertex) : MeshArena::VERTEX_FLOATS * sizeof(float)) ||
+        !sectionFits(header, header.gpuIndicesOffset, header.indexCount,
+            (header.gpuLayout & SCENE_SHORT_INDICES) ? sizeof(uint16_t) : sizeof(uint32_t)) ||
+        !sectionFits(header, header.meshesOffset, header.meshCount, sizeof(SceneFileMesh)) ||
+        !sectionFits(header, header.materialsOffset, header.materialCount, sizeof(SceneFileMaterial)) ||
+        !sectionFits(header, header.nodesOffset, header.nodeCount, sizeof(SceneFileNode)) ||
+        !sectionFits(header, header.roomsOffset, header.roomCount, sizeof(SceneFileRoom)) ||
+        !sectionFits(header, header.portalsOffset, header.portalCount, sizeof(SceneFilePortal)) ||
+        !sectionFits(header, header.fansOffset, header.fanCount, sizeof(SceneFileFan)) ||
+        !sectionFits(header, header.compositesOffset, header.compositeCount, sizeof(SceneFileComposite)) ||
+        !sectionFits(header, header.partsOffset, header.partCount, sizeof(SceneFilePart)) ||
+        !sectionFits(header, header.instancesOffset, header.instanceCount, sizeof(SceneFileInstance)) ||
+        !sectionFits(header, header.lightsOffset, header.lightCount, sizeof(SceneFileLight)))
+    {
+        std::cout << path << ": section out of range" << std::endl;
+        return false;
+    }
+
+    const SceneFileMesh* meshes = (const SceneFileMesh*)(file.data + header.meshesOffset);
+    const SceneFileMaterial* materials = (const SceneFileMaterial*)(file.data + header.materialsOffset);
+    const SceneFileNode* nodes = (const SceneFileNode*)(file.data + header.nodesOffset);
+    const SceneFileRoom* rooms = (const SceneFileRoom*)(file.data + header.roomsOffset);
+    const SceneFilePortal* portals = (const SceneFilePortal*)(file.data + header.portalsOffset);
+    const SceneFileFan* fans = (const SceneFileFan*)(file.data + header.fansOffset);
+    const SceneFileComposite* composites = (const SceneFileComposite*)(file.data + header.compositesOffset);
+    const SceneFilePart* parts = (const SceneFilePart*)(file.data + header.partsOffset);
+    const SceneFileInstance* instances = (const SceneFileInstance*)(file.data + header.instancesOffset);
+    const SceneFileLight* lights = (const SceneFileLight*)(file.data + header.lightsOffset);
+
+    // the index section the meshes are drawn from: the GL layout one when it is
+    // uploaded as stored, else the 32-bit one
+    bool gpuSections = upload && (arena.pack || header.gpuLayout == 0);
+    bool shortIndices = gpuSections && (header.gpuLayout & SCENE_SHORT_INDICES) != 0;
+    const unsigned char* drawnIndices = file.data + (gpuSections ? header.gpuIndicesOffset : header.indicesOffset);
+
+    scene.meshes.reserve(header.meshCount);
+    for (uint32_t m = 0; m < header.meshCount; m++)
+    {
+        const SceneFileMesh& mesh = meshes[m];
+        if (mesh.count < 0 || (uint64_t)mesh.firstIndex + mesh.count > header.indexCount ||
+            mesh.baseVertex < 0 || (uint32_t)mesh.baseVertex >= header.vertexCount ||
+            (mesh.lodNext != -1 && (mesh.lodNext <= (int32_t)m || mesh.lodNext >= (int32_t)header.meshCount)))
+        {
+            std::cout << path << ": mesh " << m << " is out of range" << std::endl;
+            return false;
+        }
+        if (mesh.count > 0 && (uint64_t)largestIndex(drawnIndices, shortIndices, mesh.firstIndex, mesh.count) + mesh.baseVertex >= header.vertexCount)
+        {
+            std::cout << path << ": mesh " << m << " indexes past the vertices" << std::endl;
+            return false;
+        }
+        if (!knownMode(mesh.mode))
+        {
+            std::cout << path << ": mesh " << m << " has an unknown primitive mode" << std::endl;
+            return false;
+        }
+        int id = scene.addMesh(mesh.mode, mesh.count, mesh.firstIndex, mesh.baseVertex, std::string(mesh.name, strnlen(mesh.name, sizeof(mesh.name))));
+        scene.meshes[id].boundsMin = glm::vec3(mesh.boundsMin[0], mesh.boundsMin[1], mesh.boundsMin[2]);
+        scene.meshes[id].boundsMax = glm::vec3(mesh.boundsMax[0], mesh.boundsMax[1], mesh.boundsMax[2]);
+        scene.setLod(id, mesh.lodNext, mesh.lodBelow);
+    }
+    scene.materials.reserve(header.materialCount);
+    for (uint32_t m = 0; m < header.materialCount; m++)
+        scene.addMaterial(glm::vec3(materials[m].color[0], materials[m].color[1], materials[m].color[2]),
+            std::string(materials[m].name, strnlen(materials[m].name, sizeof(materials[m].name))));
+    scene.composites.reserve(header.compositeCount);
+    for (uint32_t c = 0; c < header.compositeCount; c++)
+    {
+        const SceneFileComposite& composite = composites[c];
+        if ((uint64_t)composite.firstPart + composite.partCount > header.partCount)
+        {
+            std::cout << path << ": composite " << c << " is out of range" << std::endl;
+            return false;
+        }
+        int id = scene.addComposite(std::string(composite.name, strnlen(composite.name, sizeof(composite.name))));
+        for (uint32_t p = composite.firstPart; p < composite.firstPart + composite.partCount; p++)
+        {
+            const SceneFilePart& part = parts[p];
+            if (part.mesh < 0 || (uint32_t)part.mesh >= header.meshCount || part.material < 0 || (uint32_t)part.material >= header.materialCount)
+            {
+                std::cout << path << ": part " << p << " references a missing mesh or material" << std::endl;
+                return false;
+            }
+            scene.addPart(id, part.mesh, part.material, part.translate[0], part.translate[1], part.translate[2],
+                part.rotate[0], part.rotate[1], part.rotate[2], part.scale[0], part.scale[1], part.scale[2]);
+        }
+    }
+    // instance roots first so every part transform comes after its parent
+    scene.instances.reserve(header.instanceCount);
+    for (uint32_t i = 0; i < header.instanceCount; i++)
+    {
+        const SceneFileInstance& instance = instances[i];
+        if (instance.composite < 0 || (uint32_t)instance.composite >= header.compositeCount)
+        {
+            std::cout << path << ": instance " << i << " references a missing composite" << std::endl;
+            return false;
+        }
+        scene.addInstance(instance.composite, instance.translate[0], instance.translate[1], instance.translate[2],
+            instance.rotate[0], instance.rotate[1], instance.rotate[2], instance.scale[0], instance.scale[1], instance.scale[2]);
+    }
+    scene.nodes.reserve(header.nodeCount);
+    for (uint32_t n = 0; n < header.nodeCount; n++)
+    {
+        const SceneFileNode& node = nodes[n];
+        if (node.mesh < 0 || (uint32_t)node.mesh >= header.meshCount || node.material < 0 || (uint32_t)node.material >= header.materialCount ||
+            node.instance < -1 || node.instance >= (int32_t)header.instanceCount)
+        {
+            std::cout << path << ": node " << n << " references a missing mesh, material or instance" << std::endl;
+            return false;
+        }
+        scene.addNode(node.mesh, node.material, node.translate[0], node.translate[1], node.translate[2],
+            node.rotate[0], node.rotate[1], node.rotate[2], node.scale[0], node.scale[1], node.scale[2], node.instance);
+    }
+    for (uint32_t r = 0; r < header.roomCount; r++)
+        scene.addRoom(std::string(rooms[r].name, strnlen(rooms[r].name, sizeof(rooms[r].name))),
+            glm::vec3(rooms[r].boundsMin[0], rooms[r].boundsMin[1], rooms[r].boundsMin[2]),
+            glm::vec3(rooms[r].boundsMax[0], rooms[r].boundsMax[1], rooms[r].boundsMax[2]));
+    for (uint32_t p = 0; p < header.portalCount; p++)
+    {
+        const SceneFilePortal& portal = portals[p];
+        if (portal.rooms[0] < -1 || portal.rooms[0] >= (int32_t)header.roomCount || portal.rooms[1] < -1 || portal.rooms[1] >= (int32_t)header.roomCount)
+        {
+            std::cout << path << ": portal " << p << " references a missing room" << std::endl;
+            return false;
+        }
+        scene.addPortal(portal.rooms[0], portal.rooms[1],
+            glm::vec3(portal.boundsMin[0], portal.boundsMin[1], portal.boundsMin[2]),
+            glm::vec3(portal.boundsMax[0], portal.boundsMax[1], portal.boundsMax[2]));
+    }
+    for (uint32_t f = 0; f < header.fanCount; f++)
+    {
+        const SceneFileFan& fan = fans[f];
+        if (fan.mesh < 0 || (uint32_t)fan.mesh >= header.meshCount || fan.material < 0 || (uint32_t)fan.material >= header.materialCount ||
+            fan.instance < -1 || fan.instance >= (int32_t)header.instanceCount)
+        {
+            std::cout << path << ": fan " << f << " references a missing mesh, material or instance" << std::endl;
+            return false;
+        }
+        scene.addFan(fan.instance, glm::vec3(fan.offset[0], fan.offset[1], fan.offset[2]), fan.mesh, fan.material);
+    }
+    for (uint32_t l = 0; l < header.lightCount; l++)
+    {
+        const SceneFileLight& light = lights[l];
+        if (light.type < LIGHT_DIRECTIONAL || light.type > LIGHT_SPOT)
+        {
+            std::cout << path << ": light " << l << " has an unknown type" << std::endl;
+            return false;
+        }
+        scene.addLight(light.type, glm::vec3(light.position[0], light.position[1], light.position[2]),
+            glm::vec3(light.direction[0], light.direction[1], light.direction[2]),
+            glm::vec3(light.color[0], light.color[1], light.color[2]), light.range, light.innerCone, light.outerCone);
+    }
+
+    const float* vertices = (const float*)(file.data + header.verticesOffset);
+    const unsigned int* indices = (const unsigned int*)(file.data + header.indicesOffset);
+    if (gpuSections)
+        arena.uploadLayout(file.data + header.gpuVerticesOffset, header.vertexCount, (header.gpuLayout & SCENE_PACKED_VERTICES) != 0,
+            file.data + header.gpuIndicesOffset, header.indexCount, (header.gpuLayout & SCENE_SHORT_INDICES) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+    else if (upload)
+        arena.upload(vertices, header.vertexCount, indices, header.indexCount);
+    else
+    {
+        arena.vertices.assign(vertices, vertices + (size_t)header.vertexCount * MeshArena::VERTEX_FLOATS);
+        arena.indices.assign(indices, indices + header.indexCount);
+    }
+    return true;
+}
+
+// load time and the memory the scene occupies on the CPU and in GL buffers
+// ------------------------------------------------------------------------
+inline void reportSceneLoad(const std::string& path, const SceneGraph& scene, const MeshArena& arena, double milliseconds)
+{
+    size_t gpuBytes = arena.gpuBytes();
+    size_t cpuBytes = scene.meshes.capacity() * sizeof(Mesh) + scene.materials.capacity() * sizeof(Material) +
+        scene.nodes.capacity() * sizeof(SceneNode) + scene.rooms.capacity() * sizeof(SceneRoom) +
+        scene.portals.capacity() * sizeof(ScenePortal) + scene.fans.capacity() * sizeof(SceneFan) +
+        scene.composites.capacity() * sizeof(SceneComposite) + scene.instances.capacity() * sizeof(SceneInstance) +
+        scene.lights.capacity() * sizeof(SceneLight) +
+        (scene.meshNames.capacity() + scene.materialNames.capacity()) * sizeof(std::string) +
+        arena.vertices.capacity() * sizeof(float) + arena.indices.capacity() * sizeof(unsigned int);
+    printf("scene %s: %d nodes, %d meshes, %d materials, %d rooms, %d lights in %.2f ms; %.1f KB geometry in GL buffers, %.1f KB on the CPU\n",
+        path.c_str(), (int)scene.nodes.size(), (int)scene.meshes.size(), (int)scene.materials.size(), (int)scene.rooms.size(),
+        (int)scene.lights.size(), milliseconds, gpuBytes / 1024.0, cpuBytes / 1024.0);
+}
+
+#endif
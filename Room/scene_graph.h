@@ -0,0 +1,315 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include "mesh_arena.h"
+#include "render_stats.h"
+#include "transform_store.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <string>
+#include <vector>
+
+// a range of the arena's element buffer, drawn with one glDrawElementsBaseVertex call
+struct Mesh
+{
+    GLenum mode;
+    GLsizei count;
+    GLuint firstIndex;
+    GLint baseVertex;
+    glm::vec3 boundsMin, boundsMax;     // object space, see computeMeshBounds()
+    int lodNext;                        // coarser version of the mesh, -1 for none
+    float lodBelow;                     // projected size under which lodNext is drawn instead
+};
+
+// colour multiplied onto the mesh's vertex colours; white keeps baked colours
+struct Material
+{
+    glm::vec3 color;
+};
+
+// one placed object; all nodes live in a single contiguous array
+struct SceneNode
+{
+    // placement as authored and written back by the scene files, relative to the
+    // instance root for parts of a composite; the live copy is the node's entry
+    // in SceneGraph::transforms
+    glm::vec3 translate;
+    glm::vec3 rotate;       // euler angles in degrees
+    glm::vec3 scale;
+    int transform;
+    int mesh;
+    int material;
+    int instance;           // SceneInstance the node is a part of, -1 if placed on its own
+};
+
+// one piece of a composite, placed relative to the composite's origin
+struct ScenePart
+{
+    int mesh;
+    int material;
+    glm::vec3 translate, rotate, scale;
+};
+
+// a piece of furniture defined once in local space, e.g. a sofa or a bed
+struct SceneComposite
+{
+    std::string name;
+    std::vector<ScenePart> parts;
+};
+
+// a placed composite: one root transform with the part nodes as its children
+struct SceneInstance
+{
+    int composite;
+    glm::vec3 translate, rotate, scale;
+    int transform;
+};
+
+// a room of the multi-room layout, a cell for PortalVisibility
+struct SceneRoom
+{
+    std::string name;
+    glm::vec3 boundsMin, boundsMax;
+};
+
+// opening between two rooms; -1 stands for the outside
+struct ScenePortal
+{
+    int rooms[2];
+    glm::vec3 boundsMin, boundsMax;     // flat along one axis
+};
+
+// a ceiling fan rig (fan.h) hanging from a placed composite: offset is the hub's
+// pivot relative to that instance's root, or in world space without an instance
+struct SceneFan
+{
+    int instance;               // -1 for a rig placed on its own
+    glm::vec3 offset;
+    int mesh;
+    int material;
+};
+
+enum LightType { LIGHT_DIRECTIONAL = 0, LIGHT_POINT = 1, LIGHT_SPOT = 2 };
+
+// a light in world space; direction is where a directional or spot light shines
+// and the cone angles, in degrees from it, bound a spot light's full and zero
+// intensity. Nothing is lit past range, except by directional lights.
+struct SceneLight
+{
+    int type;                   // LightType
+    glm::vec3 position;
+    glm::vec3 direction;
+    glm::vec3 color;            // times the intensity, may exceed 1
+    float range;
+    float innerCone, outerCone;
+};
+
+// Flat scene representation walked by the render loop instead of a hand-written
+// draw block per object. Every node owns a transform in the TransformStore, which
+// also holds transforms without geometry such as composite roots and fan hubs;
+// world matrices are only rebuilt for dirty subtrees. Moving an instance only
+// touches its root.
+class SceneGraph
+{
+public:
+    std::vector<Mesh> meshes;
+    std::vector<Material> materials;
+    std::vector<SceneNode> nodes;
+    std::vector<std::string> meshNames, materialNames;
+    std::vector<SceneRoom> rooms;
+    std::vector<ScenePortal> portals;
+    std::vector<SceneFan> fans;
+    std::vector<SceneLight> lights;
+    std::vector<SceneComposite> composites;
+    std::vector<SceneInstance> instances;
+    TransformStore transforms;
+    unsigned int version = 0;               // bumped whenever a world matrix or the node list changes
+
+    int addMesh(GLenum mode, GLsizei count, GLuint firstIndex = 0, GLint baseVertex = 0, const std::string& name = "")
+    {
+        meshes.push_back({ mode, count, firstIndex, baseVertex, glm::vec3(0.0f), glm::vec3(0.0f), -1, 0.0f });
+        meshNames.push_back(name);
+        return (int)meshes.size() - 1;
+    }
+
+    // draw coarser instead of mesh once its projected size, the bounding sphere's
+    // diameter over the screen height, falls below the given size; coarser is added
+    // after mesh, so a chain always ends. See LodSelector
+    void setLod(int mesh, int coarser, float below)
+    {
+        meshes[mesh].lodNext = coarser;
+        meshes[mesh].lodBelow = below;
+    }
+
+    int addMaterial(const glm::vec3& color, const std::string& name = "")
+    {
+        materials.push_back({ color });
+        materialNames.push_back(name);
+        return (int)materials.size() - 1;
+    }
+
+    // index of a named mesh or material, -1 if there is none
+    int findMesh(const std::string& name) const
+    {
+        for (size_t m = 0; m < meshNames.size(); m++)
+            if (meshNames[m] == name)
+                return (int)m;
+        return -1;
+    }
+
+    int findMaterial(const std::string& name) const
+    {
+        for (size_t m = 0; m < materialNames.size(); m++)
+            if (materialNames[m] == name)
+                return (int)m;
+        return -1;
+    }
+
+    int findComposite(const std::string& name) const
+    {
+        for (size_t c = 0; c < composites.size(); c++)
+            if (composites[c].name == name)
+                return (int)c;
+        return -1;
+    }
+
+    int findRoom(const std::string& name) const
+    {
+        for (size_t r = 0; r < rooms.size(); r++)
+            if (rooms[r].name == name)
+                return (int)r;
+        return -1;
+    }
+
+    int addRoom(const std::string& name, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        rooms.push_back({ name, boundsMin, boundsMax });
+        return (int)rooms.size() - 1;
+    }
+
+    int addPortal(int roomA, int roomB, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        portals.push_back({ { roomA, roomB }, boundsMin, boundsMax });
+        return (int)portals.size() - 1;
+    }
+
+    int addFan(int instance, const glm::vec3& offset, int mesh, int material)
+    {
+        fans.push_back({ instance, offset, mesh, material });
+        return (int)fans.size() - 1;
+    }
+
+    int addLight(int type, const glm::vec3& position, const glm::vec3& direction, const glm::vec3& color, float range,
+        float innerCone = 0.0f, float outerCone = 0.0f)
+    {
+        glm::vec3 unit = glm::length(direction) > 0.0f ? glm::normalize(direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+        lights.push_back({ type, position, unit, color, range, innerCone, outerCone });
+        return (int)lights.size() - 1;
+    }
+
+    // object-space boxes of every mesh from the arena's CPU copy of the geometry
+    // ------------------------------------------------------------------------
+    void computeMeshBounds(const MeshArena& arena)
+    {
+        for (Mesh& mesh : meshes)
+            arena.bounds(mesh.firstIndex, mesh.count, mesh.baseVertex, mesh.boundsMin, mesh.boundsMax);
+    }
+
+    // translate, euler rotate in degrees and scale; a part of an instance is
+    // placed relative to the instance root
+    int addNode(int mesh, int material, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz,
+        int instance = -1)
+    {
+        SceneNode node;
+        node.translate = glm::vec3(tx, ty, tz);
+        node.rotate = glm::vec3(rx, ry, rz);
+        node.scale = glm::vec3(sx, sy, sz);
+        int parent = instance >= 0 ? instances[instance].transform : -1;
+        node.transform = transforms.add(parent, node.translate, TransformStore::fromEuler(node.rotate), node.scale);
+        transforms.track(node.transform);
+        node.mesh = mesh;
+        node.material = material;
+        node.instance = instance;
+        nodes.push_back(node);
+        version++;
+        return (int)nodes.size() - 1;
+    }
+
+    int addComposite(const std::string& name)
+    {
+        composites.push_back({ name, std::vector<ScenePart>() });
+        return (int)composites.size() - 1;
+    }
+
+    void addPart(int composite, int mesh, int material, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz)
+    {
+        composites[composite].parts.push_back({ mesh, material, glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz), glm::vec3(sx, sy, sz) });
+    }
+
+    // the root transform of a placed composite, without its part nodes
+    int addInstance(int composite, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz)
+    {
+        SceneInstance instance;
+        instance.composite = composite;
+        instance.translate = glm::vec3(tx, ty, tz);
+        instance.rotate = glm::vec3(rx, ry, rz);
+        instance.scale = glm::vec3(sx, sy, sz);
+        instance.transform = transforms.add(-1, instance.translate, TransformStore::fromEuler(instance.rotate), instance.scale);
+        instances.push_back(instance);
+        return (int)instances.size() - 1;
+    }
+
+    // place a composite: one root transform plus a node per part
+    // ------------------------------------------------------------------------
+    int instantiate(int composite, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz)
+    {
+        int instance = addInstance(composite, tx, ty, tz, rx, ry, rz, sx, sy, sz);
+        for (const ScenePart& part : composites[composite].parts)
+            addNode(part.mesh, part.material, part.translate.x, part.translate.y, part.translate.z,
+                part.rotate.x, part.rotate.y, part.rotate.z, part.scale.x, part.scale.y, part.scale.z, instance);
+        return instance;
+    }
+
+    void setInstanceTransform(int id, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz)
+    {
+        SceneInstance& instance = instances[id];
+        instance.translate = glm::vec3(tx, ty, tz);
+        instance.rotate = glm::vec3(rx, ry, rz);
+        instance.scale = glm::vec3(sx, sy, sz);
+        transforms.set(instance.transform, instance.translate, TransformStore::fromEuler(instance.rotate), instance.scale);
+    }
+
+    void setTransform(int id, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz)
+    {
+        SceneNode& node = nodes[id];
+        node.translate = glm::vec3(tx, ty, tz);
+        node.rotate = glm::vec3(rx, ry, rz);
+        node.scale = glm::vec3(sx, sy, sz);
+        transforms.set(node.transform, node.translate, TransformStore::fromEuler(node.rotate), node.scale);
+    }
+
+    const glm::mat4& world(const SceneNode& node) const
+    {
+        return transforms.world[node.transform];
+    }
+
+    // rebuild the world matrices of dirty subtrees; the version only moves when a
+    // node's world changed (nodes track their transforms), not for the fan rigs
+    // ------------------------------------------------------------------------
+    void update()
+    {
+        transforms.update();
+        if (transforms.trackedChanged)
+            version++;
+    }
+
+    static void drawMesh(const MeshArena& arena, const Mesh& mesh)
+    {
+        glDrawElementsBaseVertex(mesh.mode, mesh.count, arena.indexType, (void*)(mesh.firstIndex * arena.indexSize()), mesh.baseVertex);
+        countDraw(mesh.mode, mesh.count);
+    }
+};
+
+#endif
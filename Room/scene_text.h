@@ -0,0 +1,671 @@
+#ifndef SCENE_TEXT_H
+#define SCENE_TEXT_H
+
+#include "json.h"
+#include "scene_graph.h"
+#include "mesh_arena.h"
+#include "scene_file.h"
+#include "mesh_optimizer.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Text scene description (.json) for hand editing. It places instances of the meshes
+// compiled into the executable by name and lists materials, rooms, doors, fans and
+// lights; extra meshes can be given inline, their normals are computed from the
+// triangles. // comments are allowed. Composites are pieces
+// of furniture defined once relative to their origin; a node naming a composite
+// places all its parts under one root transform.
+//
+//   {
+//     "meshes":    [ { "name": "shelf", "mode": "triangles", "vertices": [x, y, z, r, g, b, ...], "indices": [...] } ],
+//     "materials": [ { "name": "floor", "color": [0.57, 0.69, 0.57] } ],
+//     "rooms":     [ { "name": "dining room", "min": [0, 0, 0], "max": [10, 5, 10] } ],
+//     "portals":   [ { "rooms": ["outside", "dining room"], "min": [0, 0, 0], "max": [0, 5, 10] } ],
+//     "fans":      [ { "instance": 7, "offset": [0.25, -0.75, 0.25], "mesh": "cube", "material": "fan_blade" } ],
+//     "lights":    [ { "type": "point", "position": [8.8, 2.4, 3.8], "color": [2, 1.6, 1.1], "range": 7 },
+//                    { "type": "spot", "position": [21.3, 2.2, 0.8], "direction": [0, -1, 0], "color": [3, 2.6, 2],
+//                      "range": 5, "inner": 25, "outer": 45 },
+//                    { "type": "directional", "direction": [0.4, -1, 0.3], "color": [0.3, 0.3, 0.3] } ],
+//     "composites": [ { "name": "table", "parts": [ { "mesh": "cube", "material": "wood", "translate": [0, 0.6, 0], "scale": [6, 0.6, 3] } ] } ],
+//     "nodes":     [ { "mesh": "cube", "material": "floor", "translate": [0, 0, 0], "rotate": [0, 0, 0], "scale": [20, 0.1, 20] },
+//                    { "composite": "table", "translate": [19.5, 0, 0.2] } ]
+//   }
+//
+// A fan's instance counts the nodes that name a composite, from 0, and its offset
+// is the hub relative to that piece; without an instance the offset is in world
+// space. rotate defaults to 0 and scale to 1. A scene is compiled into a .rscn file next to
+// it (scene.json.rscn) tagged with a hash of the text and the built-in meshes; while
+// neither changes, startup maps the compiled file instead of parsing the text.
+
+typedef void (*SceneMeshBuilder)(SceneGraph& scene, MeshArena& arena);
+
+inline bool isTextScenePath(const std::string& path)
+{
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+}
+
+namespace scene_text_detail
+{
+    inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    // hash of the text plus everything else the compiled file depends on
+    inline uint64_t sourceHash(const std::string& text, const SceneGraph& library, const MeshArena& libraryArena)
+    {
+        uint64_t hash = fnv1a(&SCENE_FILE_VERSION, sizeof(SCENE_FILE_VERSION));
+        hash = fnv1a(text.data(), text.size(), hash);
+        hash = fnv1a(libraryArena.vertices.data(), libraryArena.vertices.size() * sizeof(float), hash);
+        hash = fnv1a(libraryArena.indices.data(), libraryArena.indices.size() * sizeof(unsigned int), hash);
+        for (size_t m = 0; m < library.meshes.size(); m++)
+        {
+            const Mesh& mesh = library.meshes[m];
+            GLint range[4] = { (GLint)mesh.mode, mesh.count, (GLint)mesh.firstIndex, mesh.baseVertex };
+            hash = fnv1a(range, sizeof(range), hash);
+            hash = fnv1a(library.meshNames[m].data(), library.meshNames[m].size(), hash);
+        }
+        return hash != 0 ? hash : 1;    // 0 marks files that were not compiled from text
+    }
+
+    // shortest decimal form that reads back as the same float
+    inline std::string formatFloat(float value)
+    {
+        char text[32];
+        for (int digits = 6; digits <= 9; digits++)
+        {
+            snprintf(text, sizeof(text), "%.*g", digits, value);
+            if ((float)strtod(text, nullptr) == value)
+                break;
+        }
+        return text;
+    }
+
+    inline std::string formatVec3(const glm::vec3& v)
+    {
+        return "[" + formatFloat(v.x) + ", " + formatFloat(v.y) + ", " + formatFloat(v.z) + "]";
+    }
+
+    // translate always, rotate and scale only when they differ from the defaults
+    inline std::string formatPlacement(const glm::vec3& t, const glm::vec3& r, const glm::vec3& s)
+    {
+        std::string text = ", \"translate\": " + formatVec3(t);
+        if (r != glm::vec3(0.0f))
+            text += ", \"rotate\": " + formatVec3(r);
+        if (s != glm::vec3(1.0f))
+            text += ", \"scale\": " + formatVec3(s);
+        return text;
+    }
+
+    // Reads the parsed document into a SceneGraph and MeshArena. Every problem is
+    // printed with its line and reading goes on, so one run lists all of them.
+    class SceneTextReader
+    {
+    public:
+        SceneTextReader(const std::string& path, SceneGraph& scene, MeshArena& arena)
+            : path(path), scene(scene), arena(arena)
+        {
+        }
+
+        int errors = 0;
+
+        void read(const JsonValue& root)
+        {
+            if (root.type != JsonValue::OBJECT)
+            {
+                error(root, "the scene must be an object");
+                return;
+            }
+            checkKeys(root, { "meshes", "materials", "rooms", "portals", "fans", "lights", "composites", "nodes" });
+            // meshes and materials first, the other sections refer to them by name
+            forEach(root, "meshes", &SceneTextReader::readMesh);
+            forEach(root, "materials", &SceneTextReader::readMaterial);
+            forEach(root, "rooms", &SceneTextReader::readRoom);
+            forEach(root, "portals", &SceneTextReader::readPortal);
+            forEach(root, "lights", &SceneTextReader::readLight);
+            forEach(root, "composites", &SceneTextReader::readComposite);
+            forEach(root, "nodes", &SceneTextReader::readNode);
+            // fans hang from placed composites
+            forEach(root, "fans", &SceneTextReader::readFan);
+        }
+
+    private:
+        const std::string& path;
+        SceneGraph& scene;
+        MeshArena& arena;
+
+        void error(const JsonValue& value, const std::string& message)
+        {
+            std::cout << path << ":" << value.line << ": " << message << std::endl;
+            errors++;
+        }
+
+        void checkKeys(const JsonValue& object, std::initializer_list<const char*> known)
+        {
+            for (const auto& member : object.members)
+            {
+                bool found = false;
+                for (const char* key : known)
+                    found = found || member.first == key;
+                if (!found)
+                    error(member.second, "unknown key \"" + member.first + "\"");
+            }
+        }
+
+        void forEach(const JsonValue& root, const char* section, void (SceneTextReader::*readItem)(const JsonValue&))
+        {
+            const JsonValue* list = root.find(section);
+            if (!list)
+                return;
+            if (list->type != JsonValue::ARRAY)
+            {
+                error(*list, std::string("\"") + section + "\" must be an array");
+                return;
+            }
+            for (const JsonValue& item : list->items)
+            {
+                if (item.type != JsonValue::OBJECT)
+                    error(item, std::string("entries of \"") + section + "\" must be objects");
+                else
+                    (this->*readItem)(item);
+            }
+        }
+
+        bool readString(const JsonValue& object, const char* key, std::string& out)
+        {
+            const JsonValue* value = object.find(key);
+            if (!value || value->type != JsonValue::STRING || value->string.empty())
+            {
+                error(value ? *value : object, std::string("\"") + key + "\" must be a non-empty string");
+                return false;
+            }
+            out = value->string;
+            return true;
+        }
+
+        // names are stored in fixed 24-byte fields of the compiled file
+        bool readName(const JsonValue& object, std::string& out)
+        {
+            if (!readString(object, "name", out))
+                return false;
+            if (out.size() > 23)
+            {
+                error(*object.find("name"), "\"" + out + "\" is longer than 23 characters");
+                return false;
+            }
+            return true;
+        }
+
+        // optional when a default is given
+        bool readVec3(const JsonValue& object, const char* key, glm::vec3& out, const glm::vec3* fallback = nullptr)
+        {
+            const JsonValue* value = object.find(key);
+            if (!value && fallback)
+            {
+                out = *fallback;
+                return true;
+            }
+            if (!value || value->type != JsonValue::ARRAY || value->items.size() != 3 ||
+                value->items[0].type != JsonValue::NUMBER || value->items[1].type != JsonValue::NUMBER || value->items[2].type != JsonValue::NUMBER)
+            {
+                error(value ? *value : object, std::string("\"") + key + "\" must be an array of 3 numbers");
+                return false;
+            }
+            out = glm::vec3((float)value->items[0].number, (float)value->items[1].number, (float)value->items[2].number);
+            return true;
+        }
+
+        bool readFloat(const JsonValue& object, const char* key, float& out, const float* fallback = nullptr)
+        {
+            const JsonValue* value = object.find(key);
+            if (!value && fallback)
+            {
+                out = *fallback;
+                return true;
+            }
+            if (!value || value->type != JsonValue::NUMBER)
+            {
+                error(value ? *value : object, std::string("\"") + key + "\" must be a number");
+                return false;
+            }
+            out = (float)value->number;
+            return true;
+        }
+
+        bool readNumbers(const JsonValue& object, const char* key, std::vector<double>& out)
+        {
+            const JsonValue* value = object.find(key);
+            bool valid = value && value->type == JsonValue::ARRAY && !value->items.empty();
+            for (size_t i = 0; valid && i < value->items.size(); i++)
+                valid = value->items[i].type == JsonValue::NUMBER;
+            if (!valid)
+            {
+                error(value ? *value : object, std::string("\"") + key + "\" must be a non-empty array of numbers");
+                return false;
+            }
+            out.clear();
+            for (const JsonValue& item : value->items)
+                out.push_back(item.number);
+            return true;
+        }
+
+        int lookupMesh(const JsonValue& object, const char* key, const char* fallback = nullptr)
+        {
+            std::string name = fallback ? fallback : "";
+            const JsonValue* value = object.find(key);
+            if ((value || !fallback) && !readString(object, key, name))
+                return -1;
+            int mesh = scene.findMesh(name);
+            if (mesh < 0)
+                error(value ? *value : object, "no mesh named \"" + name + "\"");
+            return mesh;
+        }
+
+        int lookupMaterial(const JsonValue& object, const char* key)
+        {
+            std::string name;
+            if (!readString(object, key, name))
+                return -1;
+            int material = scene.findMaterial(name);
+            if (material < 0)
+                error(*object.find(key), "no material named \"" + name + "\"");
+            return material;
+        }
+
+        void readMesh(const JsonValue& item)
+        {
+            checkKeys(item, { "name", "mode", "vertices", "indices" });
+            std::string name, mode = "triangles";
+            std::vector<double> vertices, indices;
+            bool valid = readName(item, name);
+            if (item.find("mode"))
+                valid = readString(item, "mode", mode) && valid;
+            valid = readNumbers(item, "vertices", vertices) && valid;
+            valid = readNumbers(item, "indices", indices) && valid;
+            if (!valid)
+                return;
+            if (scene.findMesh(name) >= 0)
+                return error(item, "mesh \"" + name + "\" is defined twice");
+
+            GLenum glMode = GL_TRIANGLES;
+            if (mode == "lines")
+                glMode = GL_LINES;
+            else if (mode == "line_loop")
+                glMode = GL_LINE_LOOP;
+            else if (mode == "line_strip")
+                glMode = GL_LINE_STRIP;
+            else if (mode != "triangles")
+                return error(*item.find("mode"), "mode must be triangles, lines, line_loop or line_strip");
+            if (vertices.size() % 6 != 0)
+                return error(*item.find("vertices"), "vertices must be position + colour, 6 numbers each");
+            std::vector<float> vertexData(vertices.begin(), vertices.end());
+            std::vector<unsigned int> indexData;
+            for (double index : indices)
+            {
+                if (index < 0 || index >= vertices.size() / 6 || index != (unsigned int)index)
+                    return error(*item.find("indices"), "index " + formatFloat((float)index) + " is not a vertex of the mesh");
+                indexData.push_back((unsigned int)index);
+            }
+            GLuint firstIndex = arena.addIndices(indexData.data(), (int)indexData.size());
+            GLint baseVertex = arena.addVertices(vertexData.data(), (int)vertexData.size() / 6);
+            arena.computeNormals(glMode, firstIndex, (GLsizei)indexData.size(), baseVertex);
+            scene.addMesh(glMode, (GLsizei)indexData.size(), firstIndex, baseVertex, name);
+        }
+
+        void readMaterial(const JsonValue& item)
+        {
+            checkKeys(item, { "name", "color" });
+            std::string name;
+            glm::vec3 color;
+            bool valid = readName(item, name);
+            if (!readVec3(item, "color", color) || !valid)
+                return;
+            if (scene.findMaterial(name) >= 0)
+                return error(item, "material \"" + name + "\" is defined twice");
+            scene.addMaterial(color, name);
+        }
+
+        void readRoom(const JsonValue& item)
+        {
+            checkKeys(item, { "name", "min", "max" });
+            std::string name;
+            glm::vec3 boundsMin, boundsMax;
+            bool valid = readName(item, name);
+            valid = readVec3(item, "min", boundsMin) && valid;
+            if (!readVec3(item, "max", boundsMax) || !valid)
+                return;
+            if (name == "outside" || scene.findRoom(name) >= 0)
+                return error(item, "room \"" + name + "\" is defined twice");
+            if (boundsMin.x > boundsMax.x || boundsMin.y > boundsMax.y || boundsMin.z > boundsMax.z)
+                return error(item, "room \"" + name + "\" has min above max");
+            scene.addRoom(name, boundsMin, boundsMax);
+        }
+
+        void readPortal(const JsonValue& item)
+        {
+            checkKeys(item, { "rooms", "min", "max" });
+            glm::vec3 boundsMin, boundsMax;
+            const JsonValue* rooms = item.find("rooms");
+            int ids[2] = { -1, -1 };
+            bool valid = rooms && rooms->type == JsonValue::ARRAY && rooms->items.size() == 2 &&
+                rooms->items[0].type == JsonValue::STRING && rooms->items[1].type == JsonValue::STRING;
+            if (!valid)
+                error(rooms ? *rooms : item, "\"rooms\" must name the two rooms the portal connects");
+            for (int side = 0; valid && side < 2; side++)
+            {
+                const std::string& name = rooms->items[side].string;
+                ids[side] = name == "outside" ? -1 : scene.findRoom(name);
+                if (name != "outside" && ids[side] < 0)
+                {
+                    error(rooms->items[side], "no room named \"" + name + "\"");
+                    valid = false;
+                }
+            }
+            valid = readVec3(item, "min", boundsMin) && valid;
+            if (!readVec3(item, "max", boundsMax) || !valid)
+                return;
+            if (boundsMin.x != boundsMax.x && boundsMin.y != boundsMax.y && boundsMin.z != boundsMax.z)
+                return error(item, "a portal must be flat along one axis");
+            scene.addPortal(ids[0], ids[1], boundsMin, boundsMax);
+        }
+
+        void readFan(const JsonValue& item)
+        {
+            checkKeys(item, { "instance", "offset", "mesh", "material" });
+            glm::vec3 offset, zero(0.0f);
+            bool valid = readVec3(item, "offset", offset, &zero);
+            int instance = -1;
+            const JsonValue* value = item.find("instance");
+            if (value)
+            {
+                if (value->type != JsonValue::NUMBER || value->number != (int)value->number ||
+                    value->number < 0 || value->number >= (double)scene.instances.size())
+                    return error(*value, "instance must be the index of a placed composite");
+                instance = (int)value->number;
+            }
+            int mesh = lookupMesh(item, "mesh", "cube");
+            int material = lookupMaterial(item, "material");
+            if (valid && mesh >= 0 && material >= 0)
+                scene.addFan(instance, offset, mesh, material);
+        }
+
+        void readLight(const JsonValue& item)
+        {
+            std::string type;
+            if (!readString(item, "type", type))
+                return;
+            glm::vec3 position(0.0f), direction(0.0f, -1.0f, 0.0f), color;
+            float range = 0.0f, inner = 0.0f, outer = 0.0f;
+            bool valid = readVec3(item, "color", color);
+            if (type == "directional")
+            {
+                checkKeys(item, { "type", "direction", "color" });
+                if (readVec3(item, "direction", direction) && valid)
+                    scene.addLight(LIGHT_DIRECTIONAL, position, direction, color, 0.0f);
+                return;
+            }
+            if (type != "point" && type != "spot")
+                return error(*item.find("type"), "type must be point, spot or directional");
+            valid = readVec3(item, "position", position) && valid;
+            valid = readFloat(item, "range", range) && valid;
+            if (type == "point")
+            {
+                checkKeys(item, { "type", "position", "color", "range" });
+                if (valid)
+                    scene.addLight(LIGHT_POINT, position, direction, color, range);
+                return;
+            }
+            checkKeys(item, { "type", "position", "direction", "color", "range", "inner", "outer" });
+            valid = readVec3(item, "direction", direction) && valid;
+            valid = readFloat(item, "inner", inner) && valid;
+            if (!readFloat(item, "outer", outer) || !valid)
+                return;
+            if (inner < 0.0f || inner > outer || outer >= 90.0f)
+                return error(item, "spot cones must satisfy 0 <= inner <= outer < 90");
+            scene.addLight(LIGHT_SPOT, position, direction, color, range, inner, outer);
+        }
+
+        bool readPlacement(const JsonValue& item, glm::vec3& t, glm::vec3& r, glm::vec3& s)
+        {
+            glm::vec3 zero(0.0f), one(1.0f);
+            bool valid = readVec3(item, "translate", t);
+            valid = readVec3(item, "rotate", r, &zero) && valid;
+            return readVec3(item, "scale", s, &one) && valid;
+        }
+
+        void readComposite(const JsonValue& item)
+        {
+            checkKeys(item, { "name", "parts" });
+            std::string name;
+            if (!readName(item, name))
+                return;
+            if (scene.findComposite(name) >= 0)
+                return error(item, "composite \"" + name + "\" is defined twice");
+            const JsonValue* parts = item.find("parts");
+            if (!parts || parts->type != JsonValue::ARRAY || parts->items.empty())
+                return error(parts ? *parts : item, "\"parts\" must be a non-empty array");
+            int composite = scene.addComposite(name);
+            for (const JsonValue& part : parts->items)
+            {
+                if (part.type != JsonValue::OBJECT)
+                {
+                    error(part, "entries of \"parts\" must be objects");
+                    continue;
+                }
+                checkKeys(part, { "mesh", "material", "translate", "rotate", "scale" });
+                glm::vec3 t, r, s;
+                int mesh = lookupMesh(part, "mesh");
+                int material = lookupMaterial(part, "material");
+                if (readPlacement(part, t, r, s) && mesh >= 0 && material >= 0)
+                    scene.addPart(composite, mesh, material, t.x, t.y, t.z, r.x, r.y, r.z, s.x, s.y, s.z);
+            }
+        }
+
+        void readNode(const JsonValue& item)
+        {
+            glm::vec3 t, r, s;
+            if (item.find("composite"))
+            {
+                checkKeys(item, { "composite", "translate", "rotate", "scale" });
+                std::string name;
+                if (!readString(item, "composite", name))
+                    return;
+                int composite = scene.findComposite(name);
+                if (composite < 0)
+                    return error(*item.find("composite"), "no composite named \"" + name + "\"");
+                if (readPlacement(item, t, r, s))
+                    scene.instantiate(composite, t.x, t.y, t.z, r.x, r.y, r.z, s.x, s.y, s.z);
+                return;
+            }
+            checkKeys(item, { "mesh", "material", "translate", "rotate", "scale" });
+            int mesh = lookupMesh(item, "mesh");
+            int material = lookupMaterial(item, "material");
+            if (readPlacement(item, t, r, s) && mesh >= 0 && material >= 0)
+                scene.addNode(mesh, material, t.x, t.y, t.z, r.x, r.y, r.z, s.x, s.y, s.z);
+        }
+    };
+}
+
+// parse and validate a text scene on top of the meshes already in the scene
+// ------------------------------------------------------------------------
+inline bool compileSceneText(const std::string& path, const std::string& text, SceneGraph& scene, MeshArena& arena)
+{
+    JsonValue root;
+    JsonParser parser;
+    if (!parser.parse(text, root))
+    {
+        std::cout << path << ": " << parser.error << std::endl;
+        return false;
+    }
+    scene_text_detail::SceneTextReader reader(path, scene, arena);
+    reader.read(root);
+    if (reader.errors > 0)
+    {
+        std::cout << path << ": " << reader.errors << " error(s), scene not loaded" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Load a text scene through its compiled cache: map scene.json.rscn if it was built
+// from the same text and built-in meshes, otherwise compile the text, rewrite the
+// cache and upload. buildMeshes adds the built-in meshes the text refers to.
+// Without upload the geometry stays in the arena's CPU copies, as for loadSceneFile().
+// ------------------------------------------------------------------------
+inline bool loadSceneText(const std::string& path, SceneGraph& scene, MeshArena& arena, SceneMeshBuilder buildMeshes, bool upload = true)
+{
+    using namespace scene_text_detail;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "Cannot read scene " << path << std::endl;
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+
+    SceneGraph library;
+    MeshArena libraryArena;
+    buildMeshes(library, libraryArena);
+    uint64_t hash = sourceHash(text, library, libraryArena);
+
+    std::string cachePath = path + ".rscn";
+    uint64_t cachedHash = 0;
+    if (readSceneFileHash(cachePath, cachedHash) && cachedHash == hash)
+    {
+        if (loadSceneFile(cachePath, scene, arena, upload))
+        {
+            std::cout << path << " unchanged, using " << cachePath << std::endl;
+            return true;
+        }
+        scene = SceneGraph();
+    }
+
+    scene = library;
+    arena = libraryArena;
+    if (!compileSceneText(path, text, scene, arena))
+        return false;
+    printMeshOptimization(optimizeMeshes(scene, arena));
+    scene.computeMeshBounds(arena);
+    if (writeSceneFile(cachePath, scene, arena, hash))
+        std::cout << "Compiled " << path << " into " << cachePath << std::endl;
+    else
+        std::cout << "Compiled " << path << ", the cache could not be written" << std::endl;
+    if (upload)
+        arena.upload();
+    return true;
+}
+
+// write a scene as text; meshes are referenced by name, so only scenes made of the
+// built-in meshes survive the round trip
+// ------------------------------------------------------------------------
+inline bool writeSceneText(const std::string& path, const SceneGraph& scene)
+{
+    using namespace scene_text_detail;
+
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cout << "Cannot write scene " << path << std::endl;
+        return false;
+    }
+    out << "{\n  \"materials\": [\n";
+    for (size_t m = 0; m < scene.materials.size(); m++)
+        out << "    { \"name\": \"" << scene.materialNames[m] << "\", \"color\": " << formatVec3(scene.materials[m].color) << " }"
+            << (m + 1 < scene.materials.size() ? ",\n" : "\n");
+    out << "  ],\n  \"rooms\": [\n";
+    for (size_t r = 0; r < scene.rooms.size(); r++)
+        out << "    { \"name\": \"" << scene.rooms[r].name << "\", \"min\": " << formatVec3(scene.rooms[r].boundsMin)
+            << ", \"max\": " << formatVec3(scene.rooms[r].boundsMax) << " }" << (r + 1 < scene.rooms.size() ? ",\n" : "\n");
+    out << "  ],\n  \"portals\": [\n";
+    for (size_t p = 0; p < scene.portals.size(); p++)
+    {
+        const ScenePortal& portal = scene.portals[p];
+        std::string a = portal.rooms[0] < 0 ? "outside" : scene.rooms[portal.rooms[0]].name;
+        std::string b = portal.rooms[1] < 0 ? "outside" : scene.rooms[portal.rooms[1]].name;
+        out << "    { \"rooms\": [\"" << a << "\", \"" << b << "\"], \"min\": " << formatVec3(portal.boundsMin)
+            << ", \"max\": " << formatVec3(portal.boundsMax) << " }" << (p + 1 < scene.portals.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"fans\": [\n";
+    for (size_t f = 0; f < scene.fans.size(); f++)
+        out << "    { " << (scene.fans[f].instance < 0 ? std::string() : "\"instance\": " + std::to_string(scene.fans[f].instance) + ", ")
+            << "\"offset\": " << formatVec3(scene.fans[f].offset) << ", \"mesh\": \"" << scene.meshNames[scene.fans[f].mesh]
+            << "\", \"material\": \"" << scene.materialNames[scene.fans[f].material] << "\" }" << (f + 1 < scene.fans.size() ? ",\n" : "\n");
+    out << "  ],\n  \"lights\": [\n";
+    for (size_t l = 0; l < scene.lights.size(); l++)
+    {
+        const SceneLight& light = scene.lights[l];
+        if (light.type == LIGHT_DIRECTIONAL)
+            out << "    { \"type\": \"directional\", \"direction\": " << formatVec3(light.direction);
+        else
+            out << "    { \"type\": \"" << (light.type == LIGHT_SPOT ? "spot" : "point") << "\", \"position\": " << formatVec3(light.position);
+        if (light.type == LIGHT_SPOT)
+            out << ", \"direction\": " << formatVec3(light.direction);
+        out << ", \"color\": " << formatVec3(light.color);
+        if (light.type != LIGHT_DIRECTIONAL)
+            out << ", \"range\": " << formatFloat(light.range);
+        if (light.type == LIGHT_SPOT)
+            out << ", \"inner\": " << formatFloat(light.innerCone) << ", \"outer\": " << formatFloat(light.outerCone);
+        out << " }" << (l + 1 < scene.lights.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"composites\": [\n";
+    for (size_t c = 0; c < scene.composites.size(); c++)
+    {
+        const SceneComposite& composite = scene.composites[c];
+        out << "    { \"name\": \"" << composite.name << "\", \"parts\": [\n";
+        for (size_t p = 0; p < composite.parts.size(); p++)
+        {
+            const ScenePart& part = composite.parts[p];
+            out << "      { \"mesh\": \"" << scene.meshNames[part.mesh] << "\", \"material\": \"" << scene.materialNames[part.material]
+                << "\"" << formatPlacement(part.translate, part.rotate, part.scale) << " }" << (p + 1 < composite.parts.size() ? ",\n" : "\n");
+        }
+        out << "    ] }" << (c + 1 < scene.composites.size() ? ",\n" : "\n");
+    }
+    // a placed composite is written once, at its first part, and re-created from
+    // the composite when the scene is read
+    std::vector<std::string> entries;
+    std::vector<unsigned char> written(scene.instances.size(), 0);
+    for (const SceneNode& node : scene.nodes)
+    {
+        if (node.instance >= 0)
+        {
+            if (written[node.instance])
+                continue;
+            written[node.instance] = 1;
+            const SceneInstance& instance = scene.instances[node.instance];
+            entries.push_back("{ \"composite\": \"" + scene.composites[instance.composite].name + "\"" +
+                formatPlacement(instance.translate, instance.rotate, instance.scale) + " }");
+            continue;
+        }
+        entries.push_back("{ \"mesh\": \"" + scene.meshNames[node.mesh] + "\", \"material\": \"" + scene.materialNames[node.material] +
+            "\"" + formatPlacement(node.translate, node.rotate, node.scale) + " }");
+    }
+    out << "  ],\n  \"nodes\": [\n";
+    for (size_t e = 0; e < entries.size(); e++)
+        out << "    " << entries[e] << (e + 1 < entries.size() ? ",\n" : "\n");
+    out << "  ]\n}\n";
+    if (!out)
+    {
+        std::cout << "Cannot write scene " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include "render_stats.h"
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -8,14 +9,54 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+// program binaries need GL 4.1 or ARB_get_program_binary in the loader
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+#define SHADER_BINARY_CACHE 1
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// location of an active uniform, resolved once after linking
+struct UniformHandle
+{
+    GLint location = -1;
+};
+
+// fixed binding points of the uniform blocks shared by every program; GLSL 330 has
+// no layout(binding), so each Shader attaches its blocks after linking
+enum UniformBlockBinding { FRAME_DATA_BINDING = 0, LIGHT_DATA_BINDING = 1 };
+
+// result of Shader::pollReload()
+enum ShaderReload { RELOAD_IDLE, RELOAD_PENDING, RELOAD_DONE, RELOAD_FAILED };
 
 class Shader
 {
 public:
     unsigned int ID;
+    std::string vertexPath, fragmentPath;
+    // a variant compiles both files with "#define <variant>" after the #version
+    // line, so one pair of files can build programs without the code paths they
+    // do not use; empty for the plain program
+    std::string variant;
+    // Linked programs are kept in <vertexPath>[.<variant>].bin, tagged with a hash
+    // of both sources and the GL vendor/renderer/version strings. A matching file is loaded
+    // with glProgramBinary instead of compiling; if the driver rejects it the
+    // program is compiled from source and the file rewritten.
+    static bool& useBinaryCache()
+    {
+        static bool enabled = true;
+        return enabled;
+    }
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader(const char* vertexPath, const char* fragmentPath, const char* variant = "")
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), variant(variant)
     {
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
@@ -38,16 +79,23 @@ public:
             vShaderFile.close();
             fShaderFile.close();
             // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            vertexCode = withVariant(vShaderStream.str());
+            fragmentCode = withVariant(fShaderStream.str());
         }
         catch (std::ifstream::failure& e)
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
         }
+        // 2. reuse the program linked by an earlier run of the same sources and driver
+        binaryKey = sourceKey(vertexCode, fragmentCode);
+        if (loadBinary())
+        {
+            reflectUniforms();
+            return;
+        }
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
+        // 3. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -63,79 +111,432 @@ public:
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
+        retrievableHint(ID);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+        saveBinary();
+        // 4. cache the location of every active uniform
+        reflectUniforms();
+    }
+    // Start compiling the current shader files into a second program. ID keeps
+    // drawing until pollReload() finds the new program linked and swaps it in; a
+    // program that fails to compile or link is dropped and the old one stays.
+    // ------------------------------------------------------------------------
+    bool beginReload()
+    {
+        std::string vertexCode, fragmentCode;
+        if (!readSource(vertexPath, vertexCode) || !readSource(fragmentPath, fragmentCode))
+            return false;
+        vertexCode = withVariant(vertexCode);
+        fragmentCode = withVariant(fragmentCode);
+        discardReload();
+        pendingKey = sourceKey(vertexCode, fragmentCode);
+        const char* vShaderCode = vertexCode.c_str();
+        const char* fShaderCode = fragmentCode.c_str();
+        pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pendingVertex, 1, &vShaderCode, NULL);
+        glCompileShader(pendingVertex);
+        pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pendingFragment, 1, &fShaderCode, NULL);
+        glCompileShader(pendingFragment);
+        pendingID = glCreateProgram();
+        glAttachShader(pendingID, pendingVertex);
+        glAttachShader(pendingID, pendingFragment);
+        retrievableHint(pendingID);
+        glLinkProgram(pendingID);
+        pendingPolls = 0;
+        return true;
+    }
+    // Called once per frame. Status queries wait for the compiler, so they are
+    // only made once KHR_parallel_shader_compile reports the link finished, or
+    // without the extension one frame after beginReload().
+    // ------------------------------------------------------------------------
+    ShaderReload pollReload()
+    {
+        if (!pendingID)
+            return RELOAD_IDLE;
+        if (parallelCompile())
+        {
+            GLint completed = 0;
+            glGetProgramiv(pendingID, GL_COMPLETION_STATUS_KHR, &completed);
+            if (!completed)
+                return RELOAD_PENDING;
+        }
+        else if (pendingPolls++ == 0)
+            return RELOAD_PENDING;
 
+        GLint linked = 0;
+        glGetProgramiv(pendingID, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            checkCompileErrors(pendingVertex, "VERTEX");
+            checkCompileErrors(pendingFragment, "FRAGMENT");
+            checkCompileErrors(pendingID, "PROGRAM");
+            discardReload();
+            return RELOAD_FAILED;
+        }
+        glDeleteProgram(ID);
+        ID = pendingID;
+        binaryKey = pendingKey;
+        pendingID = 0;
+        discardReload();
+        saveBinary();
+        reflectUniforms();
+        return RELOAD_DONE;
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use() const
     {
         glUseProgram(ID);
+        countStateChange();
+    }
+    // look up a uniform once and keep the handle for the per-draw setters below
+    // ------------------------------------------------------------------------
+    UniformHandle uniform(const char* name) const
+    {
+        UniformHandle handle;
+        handle.location = location(name);
+        return handle;
+    }
+    // cached location of a uniform, -1 if it is not active in the program
+    // ------------------------------------------------------------------------
+    GLint location(const char* name) const
+    {
+        for (const UniformEntry& entry : uniforms)
+        {
+            if (std::strcmp(entry.name.c_str(), name) == 0)
+                return entry.location;
+        }
+        return -1;
     }
-    // utility uniform functions
+    // setters by name, one search of the uniform table per call; for setup code,
+    // per-frame callers hold a UniformHandle or CachedUniform
     // ------------------------------------------------------------------------
-    void setBool(const std::string& name, bool value) const
+    void setBool(const char* name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(location(name), (int)value);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const
+    void setInt(const char* name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(location(name), value);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const
+    void setFloat(const char* name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(location(name), value);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string& name, const glm::vec2& value) const
+    void setVec2(const char* name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform2fv(location(name), 1, &value[0]);
+        countStateChange();
     }
-    void setVec2(const std::string& name, float x, float y) const
+    void setVec2(const char* name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(location(name), x, y);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string& name, const glm::vec3& value) const
+    void setVec3(const char* name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(location(name), 1, &value[0]);
+        countStateChange();
     }
-    void setVec3(const std::string& name, float x, float y, float z) const
+    void setVec3(const char* name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(location(name), x, y, z);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string& name, const glm::vec4& value) const
+    void setVec4(const char* name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(location(name), 1, &value[0]);
+        countStateChange();
     }
-    void setVec4(const std::string& name, float x, float y, float z, float w) const
+    void setVec4(const char* name, float x, float y, float z, float w) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(location(name), x, y, z, w);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string& name, const glm::mat2& mat) const
+    void setMat2(const char* name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string& name, const glm::mat3& mat) const
+    void setMat3(const char* name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(location(name), 1, GL_FALSE, &mat[0][0]);
+        countStateChange();
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void setMat4(const char* name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
+        countStateChange();
+    }
+
+    // handle based uniform functions, no name lookup at all
+    // ------------------------------------------------------------------------
+    void setBool(UniformHandle handle, bool value) const
+    {
+        glUniform1i(handle.location, (int)value);
+        countStateChange();
+    }
+    void setInt(UniformHandle handle, int value) const
+    {
+        glUniform1i(handle.location, value);
+        countStateChange();
+    }
+    void setFloat(UniformHandle handle, float value) const
+    {
+        glUniform1f(handle.location, value);
+        countStateChange();
+    }
+    void setVec3(UniformHandle handle, const glm::vec3& value) const
+    {
+        glUniform3fv(handle.location, 1, &value[0]);
+        countStateChange();
+    }
+    void setVec4(UniformHandle handle, const glm::vec4& value) const
+    {
+        glUniform4fv(handle.location, 1, &value[0]);
+        countStateChange();
+    }
+    void setUVec4(UniformHandle handle, const GLuint* value) const
+    {
+        glUniform4uiv(handle.location, 1, value);
+        countStateChange();
+    }
+    void setMat3(UniformHandle handle, const glm::mat3& mat) const
+    {
+        glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+        countStateChange();
+    }
+    void setMat4(UniformHandle handle, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+        countStateChange();
     }
 
 private:
+    unsigned int pendingID = 0, pendingVertex = 0, pendingFragment = 0;
+    int pendingPolls = 0;
+    uint64_t binaryKey = 0, pendingKey = 0;
+
+    // ------------------------------------------------------------------------
+    // program binary cache
+    // ------------------------------------------------------------------------
+    struct BinaryHeader
+    {
+        char magic[4];
+        GLenum format;
+        uint64_t key;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    static uint64_t sourceKey(const std::string& vertexCode, const std::string& fragmentCode)
+    {
+        std::string key = vertexCode + '\0' + fragmentCode + '\0';
+        const GLenum strings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (GLenum name : strings)
+        {
+            const char* value = (const char*)glGetString(name);
+            key += value ? value : "";
+            key += '\0';
+        }
+        uint64_t hash = 14695981039346656037ull;    // FNV-1a
+        for (unsigned char c : key)
+            hash = (hash ^ c) * 1099511628211ull;
+        return hash;
+    }
+
+    static bool binarySupported()
+    {
+        static int supported = -1;
+        if (supported < 0)
+        {
+            bool loaded = false;
+#ifdef GL_VERSION_4_1
+            loaded = loaded || GLAD_GL_VERSION_4_1;
+#endif
+#ifdef GL_ARB_get_program_binary
+            loaded = loaded || GLAD_GL_ARB_get_program_binary;
+#endif
+            GLint formats = 0;
+            if (loaded)
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            supported = formats > 0 ? 1 : 0;
+        }
+        return useBinaryCache() && supported == 1;
+    }
+
+    std::string binaryPath() const
+    {
+        return variant.empty() ? vertexPath + ".bin" : vertexPath + "." + variant + ".bin";
+    }
+
+    // the source with the variant's #define after its #version line
+    std::string withVariant(const std::string& code) const
+    {
+        if (variant.empty())
+            return code;
+        size_t line = code.find('\n');
+        if (line == std::string::npos)
+            return code;
+        return code.substr(0, line + 1) + "#define " + variant + "\n" + code.substr(line + 1);
+    }
+
+    static void retrievableHint(GLuint program)
+    {
+#ifdef SHADER_BINARY_CACHE
+        if (binarySupported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+    }
+
+    bool loadBinary()
+    {
+#ifdef SHADER_BINARY_CACHE
+        if (!binarySupported())
+            return false;
+        std::ifstream file(binaryPath(), std::ios::binary);
+        BinaryHeader header;
+        if (!file.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, "PBIN", 4) != 0 || header.key != binaryKey)
+            return false;
+        std::vector<char> binary(header.length);
+        if (!file.read(binary.data(), binary.size()))
+            return false;
+        ID = glCreateProgram();
+        glProgramBinary(ID, header.format, binary.data(), (GLsizei)binary.size());
+        GLint linked = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+        if (linked)
+            return true;
+        // driver update or a binary from another GPU: compile from source
+        std::cout << "Program binary " << binaryPath() << " was rejected, compiling from source" << std::endl;
+        glDeleteProgram(ID);
+        ID = 0;
+#endif
+        return false;
+    }
+
+    void saveBinary() const
+    {
+#ifdef SHADER_BINARY_CACHE
+        GLint linked = 0, length = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+        if (!binarySupported() || !linked)
+            return;
+        glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        std::vector<char> binary(length);
+        BinaryHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "PBIN", 4);
+        header.key = binaryKey;
+        glGetProgramBinary(ID, length, NULL, &header.format, binary.data());
+        header.length = (uint32_t)length;
+        std::ofstream file(binaryPath(), std::ios::binary);
+        file.write((const char*)&header, sizeof(header));
+        file.write(binary.data(), binary.size());
+#endif
+    }
+
+    void discardReload()
+    {
+        if (pendingID)
+            glDeleteProgram(pendingID);
+        if (pendingVertex)
+            glDeleteShader(pendingVertex);
+        if (pendingFragment)
+            glDeleteShader(pendingFragment);
+        pendingID = pendingVertex = pendingFragment = 0;
+    }
+
+    static bool readSource(const std::string& path, std::string& code)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return false;
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        code = stream.str();
+        return true;
+    }
+
+    static bool parallelCompile()
+    {
+        static int supported = -1;
+        if (supported < 0)
+        {
+            supported = 0;
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++)
+            {
+                const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+                if (name && (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0 || std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0))
+                    supported = 1;
+            }
+        }
+        return supported == 1;
+    }
+
+    struct UniformEntry
+    {
+        std::string name;
+        GLint location;
+    };
+    std::vector<UniformEntry> uniforms;
+
+    // query every active uniform of the linked program once; array uniforms
+    // are stored both as "name[0]" and "name". Known uniform blocks are attached
+    // to their binding points here as well.
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        uniforms.clear();
+        GLint count = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        GLchar name[256];
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, sizeof(name), &length, &size, &type, name);
+            GLint loc = glGetUniformLocation(ID, name);
+            if (loc < 0)
+                continue;   // member of a uniform block
+            uniforms.push_back({ std::string(name, length), loc });
+            if (length > 3 && std::strcmp(name + length - 3, "[0]") == 0)
+                uniforms.push_back({ std::string(name, length - 3), loc });
+        }
+        bindBlock("FrameData", FRAME_DATA_BINDING);
+        bindBlock("LightData", LIGHT_DATA_BINDING);
+    }
+
+    void bindBlock(const char* name, GLuint binding) const
+    {
+        GLuint index = glGetUniformBlockIndex(ID, name);
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -162,5 +563,28 @@ private:
         }
     }
 };
+
+// A uniform handle looked up by name only when the program it was resolved for is
+// replaced, e.g. by a --watch reload, so per-frame code never searches the table.
+class CachedUniform
+{
+public:
+    explicit CachedUniform(const char* name) : name(name) {}
+
+    UniformHandle get(const Shader& shader) const
+    {
+        if (shader.ID != program)
+        {
+            handle = shader.uniform(name);
+            program = shader.ID;
+        }
+        return handle;
+    }
+
+private:
+    const char* name;
+    mutable UniformHandle handle;
+    mutable unsigned int program = 0;
+};
+
 #endif
-#pragma once
@@ -0,0 +1,217 @@
+#ifndef STATIC_RENDERER_H
+#define STATIC_RENDERER_H
+
+#include "shader.h"
+#include "scene_graph.h"
+#include "mesh_arena.h"
+#include "instanced_renderer.h"
+#include "lod_selector.h"
+#include "light_culler.h"
+#include "render_stats.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// indirect draws need GL 4.3 or ARB_multi_draw_indirect in the loader
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+#define STATIC_RENDERER_INDIRECT 1
+#endif
+
+// Static scene geometry drawn with glMultiDrawElementsIndirect. The instance buffer
+// (model matrix, colour and light list of every node, grouped by primitive mode,
+// mesh and material) is written once per scene version and light culling. Culling and level-of-detail changes
+// only rewrite the small command buffer: every run of visible instances of a mesh
+// drawn at the same level becomes one command, whose baseInstance points the
+// per-instance attributes at the run. The whole scene is then one multi-draw per
+// primitive mode.
+class StaticRenderer
+{
+public:
+    // layout fixed by GL, see DrawElementsIndirectCommand
+    struct Command
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // consecutive commands of one primitive mode, submitted with one call
+    struct Group
+    {
+        GLenum mode;
+        int first;
+        int count;
+    };
+
+    unsigned int instanceVBO = 0, commandBuffer = 0;
+    std::vector<InstanceData> instances;
+    std::vector<Command> commands;
+    std::vector<Group> groups;
+
+    // multi-draw indirect with a non-zero baseInstance, i.e. GL 4.3 or the
+    // ARB_multi_draw_indirect and ARB_base_instance extensions
+    // ------------------------------------------------------------------------
+    static bool supported()
+    {
+#ifdef STATIC_RENDERER_INDIRECT
+        bool indirect = false, baseInstance = false;
+#ifdef GL_VERSION_4_3
+        indirect = baseInstance = GLAD_GL_VERSION_4_3 != 0;
+#endif
+#ifdef GL_ARB_multi_draw_indirect
+        indirect = indirect || GLAD_GL_ARB_multi_draw_indirect;
+#endif
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count && !baseInstance; i++)
+        {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            baseInstance = name && strcmp(name, "GL_ARB_base_instance") == 0;
+        }
+        return indirect && baseInstance;
+#else
+        return false;
+#endif
+    }
+
+    void init(const MeshArena& arena)
+    {
+        glGenBuffers(1, &instanceVBO);
+        glGenBuffers(1, &commandBuffer);
+        arena.bind();
+        for (int i = 2; i <= 10; i++)
+            glVertexAttribDivisor(i, 1);
+    }
+
+    // instances once per scene version and light lists, commands whenever the
+    // visible set or a level of detail changes
+    // ------------------------------------------------------------------------
+    void update(const SceneGraph& scene, const std::vector<unsigned char>& visible, const LodSelector& lod, const LightCuller& lights)
+    {
+        bool rebuilt = scene.version != builtVersion || lights.version != builtLights;
+        if (rebuilt)
+            buildInstances(scene, lights);
+        if (!rebuilt && visible == builtVisible && lod.version == builtLod)
+            return;
+        builtVisible = visible;
+        builtLod = lod.version;
+
+        commands.clear();
+        groups.clear();
+        for (const Range& range : ranges)
+        {
+            for (int i = range.first; i < range.first + range.count; )
+            {
+                if (!visible[order[i]])
+                {
+                    i++;
+                    continue;
+                }
+                int start = i;
+                int level = lod.meshes[order[i]];
+                while (i < range.first + range.count && visible[order[i]] && lod.meshes[order[i]] == level)
+                    i++;
+                const Mesh& mesh = scene.meshes[level];
+                commands.push_back({ (GLuint)mesh.count, (GLuint)(i - start), mesh.firstIndex, mesh.baseVertex, (GLuint)start });
+                if (groups.empty() || groups.back().mode != mesh.mode)
+                    groups.push_back({ mesh.mode, (int)commands.size() - 1, 0 });
+                groups.back().count++;
+            }
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(Command), commands.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // one glMultiDrawElementsIndirect per primitive mode
+    // ------------------------------------------------------------------------
+    void draw(const Shader& shader, const MeshArena& arena) const
+    {
+#ifdef STATIC_RENDERER_INDIRECT
+        shader.setBool(instancedFlag.get(shader), true);
+        arena.bind();
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        InstancedRenderer::pointInstanceAttributes(0);
+        for (int i = 2; i <= 10; i++)
+            glEnableVertexAttribArray(i);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        countStateChange(11);
+        for (const Group& group : groups)
+        {
+            glMultiDrawElementsIndirect(group.mode, arena.indexType,
+                (void*)(group.first * sizeof(Command)), group.count, 0);
+            renderStats().drawCalls++;
+            if (group.mode == GL_TRIANGLES)
+                for (int c = group.first; c < group.first + group.count; c++)
+                    renderStats().triangles += (long long)(commands[c].count / 3) * commands[c].instanceCount;
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        for (int i = 2; i <= 10; i++)
+            glDisableVertexAttribArray(i);
+        countStateChange(10);
+        shader.setBool(instancedFlag.get(shader), false);
+#endif
+    }
+
+    void release()
+    {
+        glDeleteBuffers(1, &instanceVBO);
+        glDeleteBuffers(1, &commandBuffer);
+    }
+
+private:
+    CachedUniform instancedFlag{ "instanced" };
+    // instances of one mesh in the instance buffer
+    struct Range
+    {
+        int mesh;
+        int first;
+        int count;
+    };
+
+    unsigned int builtVersion = ~0u;
+    unsigned int builtLights = ~0u;
+    unsigned int builtLod = ~0u;
+    std::vector<unsigned char> builtVisible;
+    std::vector<int> order;         // scene node of every instance
+    std::vector<Range> ranges;
+
+    void buildInstances(const SceneGraph& scene, const LightCuller& lights)
+    {
+        builtVersion = scene.version;
+        builtLights = lights.version;
+        order.resize(scene.nodes.size());
+        for (size_t n = 0; n < order.size(); n++)
+            order[n] = (int)n;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            const SceneNode& na = scene.nodes[a];
+            const SceneNode& nb = scene.nodes[b];
+            GLenum ma = scene.meshes[na.mesh].mode, mb = scene.meshes[nb.mesh].mode;
+            if (ma != mb)
+                return ma < mb;
+            if (na.mesh != nb.mesh)
+                return na.mesh < nb.mesh;
+            return na.material < nb.material;
+        });
+
+        instances.resize(order.size());
+        ranges.clear();
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const SceneNode& node = scene.nodes[order[i]];
+            instances[i] = InstancedRenderer::makeInstance(scene, lights, order[i]);
+            if (ranges.empty() || ranges.back().mesh != node.mesh)
+                ranges.push_back({ node.mesh, (int)i, 0 });
+            ranges.back().count++;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), instances.data(), GL_STATIC_DRAW);
+    }
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef TIMING_OVERLAY_H
+#define TIMING_OVERLAY_H
+
+#include "shader.h"
+#include "frame_uniforms.h"
+#include "scene_graph.h"
+#include "mesh_arena.h"
+#include "frame_timer.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// On-screen frame timing: one row per timer column in the top-left corner, a solid
+// bar up to p50 and thin ticks at p95 and p99, with a grey line at the 60 Hz
+// budget. Drawn unlit with the scene shader and the unit cube mesh in pixel space.
+class TimingOverlay
+{
+public:
+    float pixelsPerMs = 24.0f;
+    float rowHeight = 10.0f;
+
+    // the pixel-space matrices replace the camera's in the frame block; the next
+    // frame uploads the camera again
+    void draw(const Shader& shader, FrameUniforms& frame, const MeshArena& arena, const Mesh& cube, const FrameTimer& timer, int width, int height)
+    {
+        static const glm::vec3 colors[T_COLUMNS] = {
+            glm::vec3(0.9f, 0.9f, 0.2f), glm::vec3(0.2f, 0.8f, 0.9f), glm::vec3(0.9f, 0.5f, 0.1f),
+            glm::vec3(0.3f, 0.9f, 0.3f), glm::vec3(0.7f, 0.4f, 0.9f), glm::vec3(1.0f, 1.0f, 1.0f),
+            glm::vec3(1.0f, 0.2f, 0.2f)
+        };
+
+        glDisable(GL_DEPTH_TEST);
+        shader.setBool(unlit.get(shader), true);
+        frame.update(glm::mat4(1.0f), glm::ortho(0.0f, (float)width, 0.0f, (float)height, -1.0f, 1.0f),
+            frame.data.cameraPosition, frame.data.time);
+        model = modelUniform.get(shader);
+        objectColor = colorUniform.get(shader);
+        arena.bind();
+
+        float left = 10.0f;
+        float top = height - 10.0f;
+        float rows = T_COLUMNS * (rowHeight + 4.0f);
+        rect(shader, arena, cube, left + 16.7f * pixelsPerMs, top - rows, 1.0f, rows, glm::vec3(0.5f));
+        for (int c = 0; c < T_COLUMNS; c++)
+        {
+            Percentiles p = timer.percentiles((TimerColumn)c);
+            float y = top - (c + 1) * (rowHeight + 4.0f);
+            rect(shader, arena, cube, left, y, p.p50 * pixelsPerMs, rowHeight, colors[c]);
+            rect(shader, arena, cube, left + p.p95 * pixelsPerMs, y, 2.0f, rowHeight, colors[c]);
+            rect(shader, arena, cube, left + p.p99 * pixelsPerMs, y - 2.0f, 2.0f, rowHeight + 4.0f, colors[c]);
+        }
+        shader.setBool(unlit.get(shader), false);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+private:
+    CachedUniform unlit{ "unlit" }, modelUniform{ "model" }, colorUniform{ "objectColor" };
+    UniformHandle model, objectColor;
+
+    // the cube mesh spans 0..0.5, so scaling by twice the size gives a pixel rectangle
+    void rect(const Shader& shader, const MeshArena& arena, const Mesh& cube, float x, float y, float w, float h, const glm::vec3& color) const
+    {
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f));
+        m = glm::scale(m, glm::vec3(2.0f * w, 2.0f * h, 1.0f));
+        shader.setMat4(model, m);
+        shader.setVec3(objectColor, color);
+        SceneGraph::drawMesh(arena, cube);
+    }
+};
+
+#endif
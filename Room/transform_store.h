@@ -0,0 +1,140 @@
+#ifndef TRANSFORM_STORE_H
+#define TRANSFORM_STORE_H
+
+#include "batch_transform.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <vector>
+
+// Placement of every object and object part as structure-of-arrays components:
+// translation, rotation quaternion and scale in separate aligned arrays, plus a
+// parent index and a dirty flag per transform. A parent always has a lower index
+// than its children, so one forward pass propagates changes down the hierarchy
+// and update() recomputes world matrices only for dirty subtrees. Transforms
+// marked with track() are counted separately, so an owner such as the scene graph
+// can tell its own transforms moving from a rig's.
+class TransformStore
+{
+public:
+    QuaternionSoA local;
+    std::vector<int> parent;                // -1 for a root
+    std::vector<unsigned char> dirty;
+    std::vector<unsigned char> changed;     // world rewritten by the last update()
+    std::vector<unsigned char> tracked;
+    std::vector<glm::mat4> world;
+    int trackedChanged = 0;                 // tracked transforms rewritten by the last update()
+
+    size_t size() const
+    {
+        return parent.size();
+    }
+
+    // parentId must already exist, or be -1
+    int add(int parentId, const glm::vec3& t, const glm::quat& r, const glm::vec3& s)
+    {
+        int id = (int)parent.size();
+        parent.push_back(parentId);
+        dirty.push_back(1);
+        changed.push_back(0);
+        tracked.push_back(0);
+        world.push_back(glm::mat4(1.0f));
+        local.resize(id + 1);
+        local.set(id, t, r, s);
+        return id;
+    }
+
+    void set(int id, const glm::vec3& t, const glm::quat& r, const glm::vec3& s)
+    {
+        local.set(id, t, r, s);
+        dirty[id] = 1;
+    }
+
+    void track(int id)
+    {
+        tracked[id] = 1;
+    }
+
+    void setRotation(int id, const glm::quat& r)
+    {
+        local.qx[id] = r.x; local.qy[id] = r.y; local.qz[id] = r.z; local.qw[id] = r.w;
+        dirty[id] = 1;
+    }
+
+    // euler angles in degrees, applied X, then Y, then Z
+    static glm::quat fromEuler(const glm::vec3& degrees)
+    {
+        return glm::angleAxis(glm::radians(degrees.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+            glm::angleAxis(glm::radians(degrees.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+            glm::angleAxis(glm::radians(degrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+
+    // recompute the world matrix of every dirty transform and of everything below
+    // it; returns how many were rewritten
+    // ------------------------------------------------------------------------
+    int update()
+    {
+        size_t count = parent.size();
+        int rewritten = 0;
+        trackedChanged = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            changed[i] = dirty[i] || (parent[i] >= 0 && changed[parent[i]]);
+            rewritten += changed[i];
+            trackedChanged += changed[i] & tracked[i];
+        }
+        if (rewritten == 0)
+            return 0;
+
+        // world = parent world * local, one lane block at a time: the block's local
+        // matrices are composed, the parents' world matrices gathered beside them
+        // (identity for a root), multiplied lane by lane and transposed back into
+        // world. A parent inside the same block is final only after its own pass,
+        // so a block takes one pass per level of nesting inside it (a fan hub and
+        // its blades take two); every pass rewrites the whole block, which leaves
+        // the unchanged lanes as they were
+        static const glm::mat4 identity(1.0f);
+        const size_t LANES = batch_detail::LANES;
+        localMatrices.resize(count);
+        parentMatrices.resize(count);
+        worldMatrices.resize(count);
+        for (size_t block = 0; block < count; block += LANES)
+        {
+            if (!blockChanged(block, count))
+                continue;
+            size_t last = std::min(block + LANES, count);
+            BatchTransform::composeQuaternions(local, localMatrices, block, last);
+            const glm::mat4* parents[batch_detail::LANES];
+            int level[batch_detail::LANES];
+            int passes = 1;
+            for (size_t i = block; i < last; i++)
+            {
+                parents[i - block] = parent[i] >= 0 ? &world[parent[i]] : &identity;
+                level[i - block] = parent[i] >= (int)block ? level[parent[i] - block] + 1 : 0;
+                passes = std::max(passes, level[i - block] + 1);
+                dirty[i] = 0;
+            }
+            for (int pass = 0; pass < passes; pass++)
+            {
+                BatchTransform::gather(parents, parentMatrices, block, last);
+                BatchTransform::multiply(parentMatrices, localMatrices, worldMatrices, block, last);
+                BatchTransform::unpack(worldMatrices, world.data(), block, last);
+            }
+        }
+        return rewritten;
+    }
+
+private:
+    MatrixSoA localMatrices, parentMatrices, worldMatrices;
+
+    bool blockChanged(size_t block, size_t count) const
+    {
+        for (size_t i = block; i < block + batch_detail::LANES && i < count; i++)
+            if (changed[i])
+                return true;
+        return false;
+    }
+};
+
+#endif
@@ -1,16 +1,47 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
+// per-instance attributes, only read when instanced is set
+layout (location = 2) in vec3 aInstanceColor;
+layout (location = 3) in mat4 aInstanceModel;
+layout (location = 7) in mat3 aInstanceNormalMatrix;
+layout (location = 10) in uvec4 aInstanceLights;
+layout (location = 11) in vec3 aNormal;
 
 out vec4 color;
+out vec3 worldPos;
+out vec3 normal;
+flat out uvec4 lights;
 
 
+// per-frame camera data, shared by every program (FrameUniforms)
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    float time;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// inverse transpose of mat3(model), computed on the CPU like the instances' one
+uniform mat3 normalMatrix;
+uniform bool instanced;
+uniform vec3 objectColor;
+// light list of a non-instanced draw, see LightCuller
+uniform uvec4 objectLights;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0f);
-    color = vec4(aColor, 1.0f);
+    mat4 world = instanced ? aInstanceModel : model;
+    vec3 tint = instanced ? aInstanceColor : objectColor;
+    vec4 position = world * vec4(aPos, 1.0f);
+    gl_Position = viewProjection * position;
+    color = vec4(aColor * tint, 1.0f);
+    worldPos = position.xyz;
+    // the inverse transpose keeps normals perpendicular under the non-uniform and
+    // mirroring scales of the furniture
+    normal = (instanced ? aInstanceNormalMatrix : normalMatrix) * aNormal;
+    lights = instanced ? aInstanceLights : objectLights;
 }